@@ -0,0 +1,50 @@
+//
+//  AVTTabbedWindows - AVTBitmapCache.h
+//
+//  Copyright (c) 2013 Avatron Software, Inc. All rights reserved.
+//
+
+#import <Cocoa/Cocoa.h>
+
+// Draws into the current graphics context, in the coordinates of a rectangle with its origin at zero and the size the image
+// was asked for.
+
+typedef void (^AVTBitmapDrawing)( void );
+
+// A cache of small pre-rendered bitmaps, for chrome that is drawn over and over with only a handful of distinct looks: tab
+// backgrounds, gradients and the like. Each image is rendered once at the backing scale it will be drawn at, and drawing it from
+// then on is a single composite.
+//
+// Keys are any copyable object that identifies everything the drawing depends on, size and scale included. The cache holds at
+// most |capacity| images; past that it is emptied and refilled by whatever is being drawn, which costs one render per look.
+
+@interface AVTBitmapCache : NSObject
+
+- (id) initWithCapacity: (NSUInteger) capacity;
+
+// Returns the image for |key|, rendering it with |drawing| into a bitmap of |size| points at |scale| the first time. The image is
+// owned by the cache, so retain it to keep it past the next call.
+
+- (CGImageRef) imageForKey: (id<NSCopying>) key size: (NSSize) size scale: (CGFloat) scale drawing: (AVTBitmapDrawing) drawing;
+
+- (void) removeAllImages;
+
+@property (nonatomic, readonly) NSUInteger capacity;
+
+// Instrumentation.
+
+@property (nonatomic, readonly) NSUInteger imageCount;
+@property (nonatomic, readonly) NSUInteger byteCount;
+@property (nonatomic, readonly) NSUInteger hitCount;
+@property (nonatomic, readonly) NSUInteger missCount;
+
+@end
+
+// Renders |drawing| into a new bitmap of |size| points at |scale|, as the cache does on a miss, for callers that keep their own
+// image. Returns NULL for an empty size. The caller releases the image.
+
+CGImageRef AVTCreateBitmap( NSSize size, CGFloat scale, AVTBitmapDrawing drawing );
+
+// Draws |image| into |rect| of the current graphics context, right side up whether or not the context is flipped.
+
+void AVTDrawBitmap( CGImageRef image, NSRect rect );
@@ -0,0 +1,128 @@
+//
+//  AVTTabbedWindows - AVTBitmapCache.m
+//
+//  Copyright (c) 2013 Avatron Software, Inc. All rights reserved.
+//
+
+#import "AVTBitmapCache.h"
+
+@interface AVTBitmapCache()
+
+@property (nonatomic, retain) NSMutableDictionary* images;  // Key -> CGImageRef, bridged as id.
+@property (nonatomic, assign) NSUInteger byteCount;
+@property (nonatomic, assign) NSUInteger hitCount;
+@property (nonatomic, assign) NSUInteger missCount;
+
+@end
+
+@implementation AVTBitmapCache
+
+- (id) initWithCapacity: (NSUInteger) capacity
+{
+    self = [super init];
+    if( self != nil )
+    {
+        _capacity = capacity;
+        _images = [[NSMutableDictionary alloc] initWithCapacity: capacity];
+    }
+
+    return self;
+}
+
+- (void) dealloc
+{
+    [_images release];
+
+    [super dealloc];
+}
+
+- (NSUInteger) imageCount
+{
+    return self.images.count;
+}
+
+- (CGImageRef) imageForKey: (id<NSCopying>) key
+                      size: (NSSize) size
+                     scale: (CGFloat) scale
+                   drawing: (AVTBitmapDrawing) drawing
+{
+    CGImageRef image = (CGImageRef)self.images[key];
+    if( image )
+    {
+        self.hitCount++;
+        return image;
+    }
+
+    self.missCount++;
+
+    image = AVTCreateBitmap( size, scale, drawing );
+    if( image == NULL )
+        return NULL;
+
+    if( self.images.count >= self.capacity )
+        [self removeAllImages];
+
+    self.images[key] = (id)image;
+    self.byteCount += CGImageGetBytesPerRow( image ) * CGImageGetHeight( image );
+    CGImageRelease( image );
+
+    return image;
+}
+
+- (void) removeAllImages
+{
+    [self.images removeAllObjects];
+    self.byteCount = 0;
+}
+
+@end
+
+CGImageRef AVTCreateBitmap( NSSize size, CGFloat scale, AVTBitmapDrawing drawing )
+{
+    size_t width = (size_t)ceil( size.width * scale );
+    size_t height = (size_t)ceil( size.height * scale );
+    if( width == 0 || height == 0 )
+        return NULL;
+
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    CGContextRef context = CGBitmapContextCreate( NULL, width, height, 8, 0, colorSpace, kCGImageAlphaPremultipliedFirst | kCGBitmapByteOrder32Host );
+    CGColorSpaceRelease( colorSpace );
+    if( context == NULL )
+        return NULL;
+
+    CGContextScaleCTM( context, scale, scale );
+
+    [NSGraphicsContext saveGraphicsState];
+    [NSGraphicsContext setCurrentContext: [NSGraphicsContext graphicsContextWithGraphicsPort: context flipped: NO]];
+    drawing();
+    [NSGraphicsContext restoreGraphicsState];
+
+    CGImageRef image = CGBitmapContextCreateImage( context );
+    CGContextRelease( context );
+
+    return image;
+}
+
+void AVTDrawBitmap( CGImageRef image, NSRect rect )
+{
+    if( image == NULL )
+        return;
+
+    NSGraphicsContext* graphicsContext = [NSGraphicsContext currentContext];
+    CGContextRef context = [graphicsContext graphicsPort];
+
+    // Core Graphics always draws images bottom up, so undo the flip of a flipped context or the image lands upside down.
+
+    if( [graphicsContext isFlipped] )
+    {
+        CGContextSaveGState( context );
+        CGContextTranslateCTM( context, 0, NSMaxY( rect ) );
+        CGContextScaleCTM( context, 1, -1 );
+        CGContextDrawImage( context, CGRectMake( NSMinX( rect ), 0, NSWidth( rect ), NSHeight( rect ) ), image );
+        CGContextRestoreGState( context );
+    }
+    else
+    {
+        CGContextDrawImage( context, NSRectToCGRect( rect ), image );
+    }
+}
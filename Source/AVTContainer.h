@@ -20,6 +20,7 @@ typedef enum
 
 @class AVTContainerWindowController;
 @class AVTTabDocument;
+@class AVTTabLoadingScheduler;
 @class AVTTabWellModel;
 @class AVTToolbarController;
 @class AVTTabDocumentController;
@@ -60,6 +61,13 @@ typedef enum
 - (AVTTabDocument*) addTabDocument: (AVTTabDocument*) document inForeground: (BOOL) foreground;
 - (AVTTabDocument*) addTabDocument: (AVTTabDocument*) document;
 
+// Add many tabs at once, the first at |index| (-1 appends) and the rest after it in order. The model inserts them as one run with
+// a single notification, the tab well creates their document controllers only as they are needed and lays out once, and if
+// |select| is YES the first of them is selected, once. Use this rather than a loop over |-addTabDocument:| to open a folder of
+// documents.
+
+- (void) addTabDocuments: (NSArray*) documents atIndex: (NSInteger) index selecting: (BOOL) select;
+
 // Commands
 
 - (void) newWindow;
@@ -86,6 +94,8 @@ typedef enum
 
 + (void) executeCommand: (NSUInteger) cmd;
 
+// Brings the tab of |document| up to date with its loading state. The loading scheduler calls this as it changes the state.
+
 - (void) loadingStateDidChange: (AVTTabDocument*) document;
 - (void) windowDidBeginToClose;
 
@@ -105,6 +115,7 @@ typedef enum
 - (void) closeAllTabs;
 
 @property (nonatomic, readonly) AVTTabWellModel* tabWellModel;
+@property (nonatomic, readonly) AVTTabLoadingScheduler* loadingScheduler;     // Runs the loading work of the tabs.
 @property (nonatomic, retain) AVTContainerWindowController* windowController;
 @property (nonatomic, readonly) NSWindow* window;
 
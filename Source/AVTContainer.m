@@ -9,9 +9,12 @@
 #import "AVTContainer.h"
 
 #import "AVTContainerCommands.h"
+#import "AVTContainerRegistry.h"
 #import "AVTContainerWindowController.h"
 #import "AVTTabDocument.h"
 #import "AVTTabDocumentController.h"
+#import "AVTTabLoadingScheduler.h"
+#import "AVTTabWellController.h"
 #import "AVTTabWellModel.h"
 #import "AVTToolbarController.h"
 
@@ -28,12 +31,18 @@
     if( self != nil )
     {
         _tabWellModel = [[AVTTabWellModel alloc] initWithDelegate: self];
+        _loadingScheduler = [[AVTTabLoadingScheduler alloc] initWithContainer: self];
+        [[AVTContainerRegistry sharedRegistry] addContainer: self];
     }
     return self;
 }
 
 - (void) dealloc
 {
+    [[AVTContainerRegistry sharedRegistry] removeContainer: self];
+
+    [_loadingScheduler invalidate];
+    [_loadingScheduler release];
     [_tabWellModel release];
     [_windowController release];
 
@@ -125,6 +134,24 @@
     return [self addTabDocument: document atIndex: -1 inForeground: YES];
 }
 
+- (void) addTabDocuments: (NSArray*) documents
+                 atIndex: (NSInteger) index
+               selecting: (BOOL) select
+{
+    if( documents.count == 0 )
+        return;
+
+    [self.tabWellModel insertTabDocuments: documents atIndex: index selecting: select];
+
+    // Only the selected document is on screen. See |-addTabDocument:atIndex:inForeground:|.
+
+    for( AVTTabDocument* document in documents )
+    {
+        if( !select || document != documents[0] )
+            document.isVisible = NO;
+    }
+}
+
 #pragma mark - Commands
 
 - (void) newWindow
@@ -329,7 +356,7 @@
 
 - (void) loadingStateDidChange: (AVTTabDocument*) document
 {
-    // TODO: Make sure the loading state is updated correctly
+    [self.windowController.tabWellController updateLoadingStateForDocument: document];
 }
 
 - (void) windowDidBeginToClose
@@ -0,0 +1,62 @@
+//
+//  AVTTabbedWindows - AVTContainerRegistry.h
+//
+//  Copyright (c) 2013 Avatron Software, Inc. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@class AVTContainer;
+@class AVTTabDocument;
+
+// Decides whether a tab is part of a cross-window query. |index| is the tab's index in |container|'s model.
+
+typedef BOOL (^AVTTabDocumentTest)( AVTTabDocument* document, AVTContainer* container, NSInteger index );
+
+// Every live container in the process, with the container holding each tab document. Containers add themselves when they are
+// created and remove themselves when they go away, and the registry follows their models' insert, detach, move and replace
+// notifications, so finding the window that holds a document is a table lookup rather than a walk over every window and every
+// model.
+//
+// The index of a document within its container is worked out per container and only again after that container's model changes,
+// so repeated lookups into a window cost one pass over its tabs between changes.
+
+@interface AVTContainerRegistry : NSObject
+
++ (AVTContainerRegistry*) sharedRegistry;
+
+// Called by AVTContainer. Containers are not retained.
+
+- (void) addContainer: (AVTContainer*) container;
+- (void) removeContainer: (AVTContainer*) container;
+
+// Returns the container holding |document|, or nil.
+
+- (AVTContainer*) containerForTabDocument: (AVTTabDocument*) document;
+
+// Returns the index of |document| in its container's model, or kNoTab. |container| is set to the container if it isn't NULL.
+
+- (NSInteger) indexOfTabDocument: (AVTTabDocument*) document container: (AVTContainer**) container;
+
+// Returns the documents of every container that pass |test|, container by container in model order.
+
+- (NSArray*) tabDocumentsPassingTest: (AVTTabDocumentTest) test;
+
+// Closes every tab that passes |test|, in every container. A window left without tabs is closed as well. Returns the number of
+// tabs asked to close; tabs with unload listeners may not have closed yet.
+
+- (NSUInteger) closeTabDocumentsPassingTest: (AVTTabDocumentTest) test;
+
+// Moves |documents| from whatever containers hold them into |container|, in the order given, without selecting them. Windows
+// left without tabs are closed.
+
+- (void) gatherTabDocuments: (NSArray*) documents intoContainer: (AVTContainer*) container;
+
+// Moves every tab of every other container into |container|.
+
+- (void) gatherAllTabDocumentsIntoContainer: (AVTContainer*) container;
+
+@property (nonatomic, readonly) NSArray* containers;
+@property (nonatomic, readonly) NSUInteger tabDocumentCount;
+
+@end
@@ -0,0 +1,326 @@
+//
+//  AVTTabbedWindows - AVTContainerRegistry.m
+//
+//  Copyright (c) 2013 Avatron Software, Inc. All rights reserved.
+//
+
+#import "AVTContainerRegistry.h"
+
+#import "AVTContainer.h"
+#import "AVTTabWellModel.h"
+
+@interface AVTContainerRegistry()
+
+- (AVTContainer*) containerForModel: (AVTTabWellModel*) model;
+- (NSMapTable*) indexTableForContainer: (AVTContainer*) container;
+- (void) closeEmptyContainers: (NSArray*) containers;
+
+- (void) tabInserted: (NSNotification*) notification;
+- (void) tabsInserted: (NSNotification*) notification;
+- (void) tabDetached: (NSNotification*) notification;
+- (void) tabMoved: (NSNotification*) notification;
+- (void) tabReplaced: (NSNotification*) notification;
+
+@property (nonatomic, retain) NSHashTable* containerSet;        // Not retained.
+@property (nonatomic, retain) NSMapTable* documentContainers;   // Document -> container, neither retained.
+@property (nonatomic, retain) NSMapTable* indexTables;          // Container -> (document -> index), rebuilt after a change.
+
+@end
+
+@implementation AVTContainerRegistry
+
++ (AVTContainerRegistry*) sharedRegistry
+{
+    static AVTContainerRegistry* sSharedRegistry = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once( &onceToken, ^{
+        sSharedRegistry = [[AVTContainerRegistry alloc] init];
+    } );
+
+    return sSharedRegistry;
+}
+
+- (id) init
+{
+    self = [super init];
+    if( self != nil )
+    {
+        NSPointerFunctionsOptions weakOptions = NSPointerFunctionsOpaqueMemory | NSPointerFunctionsObjectPointerPersonality;
+
+        _containerSet = [[NSHashTable alloc] initWithOptions: weakOptions capacity: 0];
+        _documentContainers = [[NSMapTable alloc] initWithKeyOptions: weakOptions valueOptions: weakOptions capacity: 0];
+        _indexTables = [[NSMapTable alloc] initWithKeyOptions: weakOptions
+                                                 valueOptions: NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPersonality
+                                                     capacity: 0];
+
+        // Models post with themselves as the object; their delegate is the container.
+
+        NSNotificationCenter* center = [NSNotificationCenter defaultCenter];
+        [center addObserver: self selector: @selector( tabInserted: ) name: kDidInsertTabDocumentNotification object: nil];
+        [center addObserver: self selector: @selector( tabsInserted: ) name: kDidInsertTabDocumentsNotification object: nil];
+        [center addObserver: self selector: @selector( tabDetached: ) name: kDidDetachTabDocumentNotification object: nil];
+        [center addObserver: self selector: @selector( tabMoved: ) name: kTabDocumentDidMoveNotification object: nil];
+        [center addObserver: self selector: @selector( tabReplaced: ) name: kTabDocumentDidGetReplacedNotification object: nil];
+    }
+
+    return self;
+}
+
+- (void) dealloc
+{
+    [[NSNotificationCenter defaultCenter] removeObserver: self];
+
+    [_containerSet release];
+    [_documentContainers release];
+    [_indexTables release];
+
+    [super dealloc];
+}
+
+- (NSArray*) containers
+{
+    return [self.containerSet allObjects];
+}
+
+- (NSUInteger) tabDocumentCount
+{
+    return self.documentContainers.count;
+}
+
+- (void) addContainer: (AVTContainer*) container
+{
+    [self.containerSet addObject: container];
+
+    AVTTabWellModel* model = container.tabWellModel;
+    NSUInteger count = model.count;
+    for( NSUInteger index = 0; index < count; index++ )
+        [self.documentContainers setObject: container forKey: [model tabDocumentAtIndex: index]];
+}
+
+- (void) removeContainer: (AVTContainer*) container
+{
+    if( ![self.containerSet containsObject: container] )
+        return;
+
+    [self.containerSet removeObject: container];
+    [self.indexTables removeObjectForKey: container];
+
+    // A container usually goes away empty; drop whatever it still held.
+
+    for( AVTTabDocument* document in [[self.documentContainers keyEnumerator] allObjects] )
+    {
+        if( [self.documentContainers objectForKey: document] == container )
+            [self.documentContainers removeObjectForKey: document];
+    }
+}
+
+- (AVTContainer*) containerForTabDocument: (AVTTabDocument*) document
+{
+    return document ? [self.documentContainers objectForKey: document] : nil;
+}
+
+- (NSInteger) indexOfTabDocument: (AVTTabDocument*) document
+                       container: (AVTContainer**) outContainer
+{
+    AVTContainer* container = [self containerForTabDocument: document];
+    if( outContainer )
+        *outContainer = container;
+
+    if( container == nil )
+        return kNoTab;
+
+    NSNumber* index = [[self indexTableForContainer: container] objectForKey: document];
+    return index ? [index integerValue] : kNoTab;
+}
+
+- (NSArray*) tabDocumentsPassingTest: (AVTTabDocumentTest) test
+{
+    NSMutableArray* documents = [NSMutableArray array];
+    for( AVTContainer* container in self.containers )
+    {
+        AVTTabWellModel* model = container.tabWellModel;
+        NSUInteger count = model.count;
+        for( NSUInteger index = 0; index < count; index++ )
+        {
+            AVTTabDocument* document = [model tabDocumentAtIndex: index];
+            if( test( document, container, index ) )
+                [documents addObject: document];
+        }
+    }
+
+    return documents;
+}
+
+- (NSUInteger) closeTabDocumentsPassingTest: (AVTTabDocumentTest) test
+{
+    // Find everything first: closing changes the models, and with them the registry.
+
+    NSArray* containers = self.containers;
+    NSMutableArray* matches = [NSMutableArray arrayWithCapacity: containers.count];
+    for( AVTContainer* container in containers )
+    {
+        NSMutableIndexSet* indexes = [NSMutableIndexSet indexSet];
+        AVTTabWellModel* model = container.tabWellModel;
+        NSUInteger count = model.count;
+        for( NSUInteger index = 0; index < count; index++ )
+        {
+            if( test( [model tabDocumentAtIndex: index], container, index ) )
+                [indexes addIndex: index];
+        }
+
+        [matches addObject: indexes];
+    }
+
+    // Close from the back of each model so the indexes still to close don't move.
+
+    NSUInteger closeCount = 0;
+    NSMutableArray* closedFrom = [NSMutableArray array];
+    for( NSUInteger i = 0; i < containers.count; i++ )
+    {
+        AVTContainer* container = containers[i];
+        NSIndexSet* indexes = matches[i];
+        if( indexes.count == 0 )
+            continue;
+
+        [indexes enumerateIndexesWithOptions: NSEnumerationReverse usingBlock: ^( NSUInteger index, BOOL* stop ) {
+            [container closeTabAtIndex: index makeHistory: NO];
+        }];
+
+        closeCount += indexes.count;
+        [closedFrom addObject: container];
+    }
+
+    [self closeEmptyContainers: closedFrom];
+
+    return closeCount;
+}
+
+- (void) gatherTabDocuments: (NSArray*) documents
+              intoContainer: (AVTContainer*) container
+{
+    NSMutableArray* sources = [NSMutableArray array];
+    for( AVTTabDocument* document in documents )
+    {
+        AVTContainer* source = nil;
+        NSInteger index = [self indexOfTabDocument: document container: &source];
+        if( source == nil || source == container )
+            continue;
+
+        // The source model may hold the only reference to the document, so keep it alive between the two.
+
+        [document retain];
+        [source.tabWellModel detachTabDocumentAtIndex: index];
+        [container addTabDocument: document inForeground: NO];
+        [document release];
+
+        if( ![sources containsObject: source] )
+            [sources addObject: source];
+    }
+
+    [self closeEmptyContainers: sources];
+}
+
+- (void) gatherAllTabDocumentsIntoContainer: (AVTContainer*) container
+{
+    NSMutableArray* documents = [NSMutableArray array];
+    for( AVTContainer* source in self.containers )
+    {
+        if( source != container )
+            [documents addObjectsFromArray: [source allTabDocuments]];
+    }
+
+    [self gatherTabDocuments: documents intoContainer: container];
+}
+
+#pragma mark - Implementation
+
+- (AVTContainer*) containerForModel: (AVTTabWellModel*) model
+{
+    id delegate = model.delegate;
+    return [self.containerSet containsObject: delegate] ? delegate : nil;
+}
+
+- (NSMapTable*) indexTableForContainer: (AVTContainer*) container
+{
+    NSMapTable* indexTable = [self.indexTables objectForKey: container];
+    if( indexTable == nil )
+    {
+        AVTTabWellModel* model = container.tabWellModel;
+        NSUInteger count = model.count;
+        indexTable = [[NSMapTable alloc] initWithKeyOptions: NSPointerFunctionsOpaqueMemory | NSPointerFunctionsObjectPointerPersonality
+                                               valueOptions: NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPersonality
+                                                   capacity: count];
+        for( NSUInteger index = 0; index < count; index++ )
+            [indexTable setObject: @(index) forKey: [model tabDocumentAtIndex: index]];
+
+        [self.indexTables setObject: indexTable forKey: container];
+        [indexTable release];
+    }
+
+    return indexTable;
+}
+
+// Closes the windows of any of |containers| that no longer have tabs. Tabs waiting on unload listeners keep their window open.
+
+- (void) closeEmptyContainers: (NSArray*) containers
+{
+    for( AVTContainer* container in containers )
+    {
+        if( container.tabCount == 0 )
+            [container closeWindow];
+    }
+}
+
+- (void) tabInserted: (NSNotification*) notification
+{
+    AVTContainer* container = [self containerForModel: notification.object];
+    if( container )
+    {
+        [self.documentContainers setObject: container forKey: notification.userInfo[kTabDocumentKey]];
+        [self.indexTables removeObjectForKey: container];
+    }
+}
+
+- (void) tabsInserted: (NSNotification*) notification
+{
+    AVTContainer* container = [self containerForModel: notification.object];
+    if( container )
+    {
+        for( AVTTabDocument* document in notification.userInfo[kTabDocumentsKey] )
+            [self.documentContainers setObject: container forKey: document];
+        [self.indexTables removeObjectForKey: container];
+    }
+}
+
+- (void) tabDetached: (NSNotification*) notification
+{
+    AVTContainer* container = [self containerForModel: notification.object];
+    if( container )
+    {
+        AVTTabDocument* document = notification.userInfo[kTabDocumentKey];
+        if( [self.documentContainers objectForKey: document] == container )
+            [self.documentContainers removeObjectForKey: document];
+
+        [self.indexTables removeObjectForKey: container];
+    }
+}
+
+- (void) tabMoved: (NSNotification*) notification
+{
+    AVTContainer* container = [self containerForModel: notification.object];
+    if( container )
+        [self.indexTables removeObjectForKey: container];
+}
+
+- (void) tabReplaced: (NSNotification*) notification
+{
+    AVTContainer* container = [self containerForModel: notification.object];
+    if( container )
+    {
+        [self.documentContainers removeObjectForKey: notification.userInfo[kOldTabDocumentKey]];
+        [self.documentContainers setObject: container forKey: notification.userInfo[kNewTabDocumentKey]];
+        [self.indexTables removeObjectForKey: container];
+    }
+}
+
+@end
@@ -47,4 +47,15 @@
 
 @property (nonatomic, readonly) BOOL tabDraggingAllowed;
 
+// YES while the controller waits, hidden and empty, in the window pool to be handed out for a tear-off. A pooled controller is never
+// the main container window controller.
+
+@property (nonatomic, assign, getter=isPooled) BOOL pooled;
+
+// Frame times of the most recent live resize: the number of resize steps, and the average and longest time between steps.
+
+@property (nonatomic, readonly) NSUInteger liveResizeStepCount;
+@property (nonatomic, readonly) NSTimeInterval averageLiveResizeStep;
+@property (nonatomic, readonly) NSTimeInterval longestLiveResizeStep;
+
 @end
@@ -9,6 +9,7 @@
 #import "AVTContainerWindowController.h"
 
 #import "AVTContainer.h"
+#import "AVTContainerWindowPool.h"
 #import "AVTFastResizeView.h"
 #import "AVTTabDocument.h"
 #import "AVTTabView.h"
@@ -31,6 +32,11 @@ static AVTContainerWindowController* sCurrentMainWindowController = nil; // weak
 
 @property (nonatomic, assign) BOOL initializing;
 
+@property (nonatomic, assign) CFAbsoluteTime lastLiveResizeStepTime;
+@property (nonatomic, assign) NSUInteger liveResizeStepCount;
+@property (nonatomic, assign) NSTimeInterval liveResizeDuration;
+@property (nonatomic, assign) NSTimeInterval longestLiveResizeStep;
+
 @end
 
 @implementation NSDocumentController( AVTContainerWindowControllerAdditions )
@@ -90,15 +96,19 @@ static AVTContainerWindowController* sCurrentMainWindowController = nil; // weak
         [[NSNotificationCenter defaultCenter] addObserver: self
                                                  selector: @selector( tabInserted: )
                                                      name: kDidInsertTabDocumentNotification
-                                                   object: nil];
+                                                   object: _container.tabWellModel];
+        [[NSNotificationCenter defaultCenter] addObserver: self
+                                                 selector: @selector( tabsInserted: )
+                                                     name: kDidInsertTabDocumentsNotification
+                                                   object: _container.tabWellModel];
         [[NSNotificationCenter defaultCenter] addObserver: self
                                                  selector: @selector( tabSelected: )
                                                      name: kDidSelectTabDocumentNotification
-                                                   object: nil];
+                                                   object: _container.tabWellModel];
         [[NSNotificationCenter defaultCenter] addObserver: self
                                                  selector: @selector( tabClosing: )
                                                      name: kWillCloseTabDocumentNotification
-                                                   object: nil];
+                                                   object: _container.tabWellModel];
 //        [[NSNotificationCenter defaultCenter] addObserver: self
 //                                                 selector: @selector( tabReplaced: )
 //                                                     name: ???
@@ -106,7 +116,7 @@ static AVTContainerWindowController* sCurrentMainWindowController = nil; // weak
         [[NSNotificationCenter defaultCenter] addObserver: self
                                                  selector: @selector( tabDetached: )
                                                      name: kDidDetachTabDocumentNotification
-                                                   object: nil];
+                                                   object: _container.tabWellModel];
 
         // Note: the below statement including self.window implicitly loads the window and thus initializes IBOutlets, needed later.
         // If self.window is not called (i.e. code removed), substitute the loading with a call to [self loadWindow]
@@ -146,6 +156,10 @@ static AVTContainerWindowController* sCurrentMainWindowController = nil; // weak
         {
             sCurrentMainWindowController = self;
         }
+
+        // Have a window of this kind built ahead of time for the first tab torn out of this one.
+
+        [[AVTContainerWindowPool sharedPool] prepareControllersOfClass: [self class] containerClass: [container class]];
     }
 
     return self;
@@ -186,11 +200,22 @@ static AVTContainerWindowController* sCurrentMainWindowController = nil; // weak
     _toolbarController = nil;
 
     [_container release];
+
+    // A pending tab layout would otherwise keep the tab well controller alive past its views.
+
+    [NSObject cancelPreviousPerformRequestsWithTarget: _tabWellController];
     [_tabWellController release];
 
     [super dealloc];
 }
 
+- (void) setPooled: (BOOL) pooled
+{
+    _pooled = pooled;
+    if( _pooled && sCurrentMainWindowController == self )
+        sCurrentMainWindowController = nil;
+}
+
 - (BOOL) hasTabWell
 {
     return YES;
@@ -341,8 +366,9 @@ static AVTContainerWindowController* sCurrentMainWindowController = nil; // weak
         [self.tabWellController setIndentForControls: (fullscreen ? 0 : [[self.tabWellController class] defaultIndentForControls] )];
 
         // TODO(viettrungluu): Seems kind of bad -- shouldn't |-layoutSubviews| do this? Moreover, |-layoutTabs| will try to animate....
+        // The request is merged with any the tab well made itself for the same change.
 
-        [self.tabWellController layoutTabs];
+        [self.tabWellController setNeedsTabLayout];
     }
 
     return maxY;
@@ -449,6 +475,8 @@ static AVTContainerWindowController* sCurrentMainWindowController = nil; // weak
 
 - (AVTTabWindowController*) detachTabToNewWindow: (AVTTabView*) tabView
 {
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+
     // Disable screen updates so that this appears as a single visual change.
 
     AVTContainerWindowController* controller = nil;
@@ -487,13 +515,14 @@ static AVTContainerWindowController* sCurrentMainWindowController = nil; // weak
         // Create the new browser with a single tab in its model, the one being dragged. Note that we do not retain
         // the (autoreleased) reference since the new browser will be owned by a window controller (created later)
 
-        // New container
-
-        AVTContainer* newContainer = [[self.container class] container];
+        // Take a ready-made window from the pool, or build one with a new container if there isn't one.
 
-        // Create a new window controller with the browser.
+        AVTContainerWindowPool* pool = [AVTContainerWindowPool sharedPool];
+        controller = [pool dequeueControllerOfClass: [self class] containerClass: [self.container class]];
+        if( controller == nil )
+            controller = [[[[self class] alloc] initWithContainer: [[self.container class] container]] autorelease];
 
-        controller = [[[[self class] alloc] initWithContainer: newContainer] autorelease];
+        AVTContainer* newContainer = controller.container;
 
         // Add the tab to the browser (we do it here after creating the window
         // controller so that notifications are properly delegated)
@@ -514,12 +543,16 @@ static AVTContainerWindowController* sCurrentMainWindowController = nil; // weak
 
         tabRect.size.height = [AVTTabWellController defaultTabHeight];
 
-        // And make sure we use the correct frame in the new view.
+        // And make sure we use the correct frame in the new view. The insert, resize and pin above only requested a layout; run
+        // it now so the pending pass doesn't move the tab away from the cursor after its frame is set.
 
+        [controller.tabWellController layoutTabsIfNeeded];
         [controller.tabWellController setFrameOfSelectedTab: tabRect];
     }
     NSEnableScreenUpdates();
 
+    [[AVTContainerWindowPool sharedPool] noteTearOffDuration: CFAbsoluteTimeGetCurrent() - startTime];
+
     return controller;
 }
 
@@ -782,6 +815,48 @@ static AVTContainerWindowController* sCurrentMainWindowController = nil; // weak
     //  [floatingBarBackingView_ setNeedsDisplay:YES];  // Okay even if nil.
 }
 
+// While the window is live resized the selected document's view keeps its size, pinned to the top left of the content area, and
+// the gaps are filled in with white, so the document isn't laid out on every step. Tab layout is throttled by the tab well
+// controller. Both are brought up to date once the resize is over.
+
+- (void) windowWillStartLiveResize: (NSNotification*) notification
+{
+    self.lastLiveResizeStepTime = CFAbsoluteTimeGetCurrent();
+    self.liveResizeStepCount = 0;
+    self.liveResizeDuration = 0;
+    self.longestLiveResizeStep = 0;
+
+    self.tabContentArea.fastResizeMode = YES;
+}
+
+// Each resize step during a live resize is timed from the previous one, which covers the layout and drawing of the step.
+
+- (void) windowDidResize: (NSNotification*) notification
+{
+    if( [self.window inLiveResize] )
+    {
+        CFAbsoluteTime now = CFAbsoluteTimeGetCurrent();
+        NSTimeInterval step = now - self.lastLiveResizeStepTime;
+        self.lastLiveResizeStepTime = now;
+
+        self.liveResizeStepCount++;
+        self.liveResizeDuration += step;
+        self.longestLiveResizeStep = MAX( self.longestLiveResizeStep, step );
+    }
+}
+
+- (void) windowDidEndLiveResize: (NSNotification*) notification
+{
+    self.tabContentArea.fastResizeMode = NO;
+    [self layoutSubviews];
+    [self.tabWellController layoutTabsAfterLiveResize];
+}
+
+- (NSTimeInterval) averageLiveResizeStep
+{
+    return self.liveResizeStepCount ? self.liveResizeDuration / self.liveResizeStepCount : 0;
+}
+
 // Called when we are activated (when we gain focus).
 
 - (void) windowDidBecomeKey: (NSNotification*) notification
@@ -880,6 +955,18 @@ static AVTContainerWindowController* sCurrentMainWindowController = nil; // weak
                            inForeground: inForeground];
 }
 
+- (void) tabsInserted: (NSNotification*) notification
+{
+    NSDictionary* userInfo = notification.userInfo;
+    NSInteger modelIndex = [userInfo[kTabDocumentIndexKey] integerValue];
+    for( AVTTabDocument* document in userInfo[kTabDocumentsKey] )
+    {
+        [document tabDidInsertIntoContainer: self.container
+                                    atIndex: modelIndex++
+                               inForeground: NO];
+    }
+}
+
 - (void) tabSelected: (NSNotification*) notification
 {
     NSDictionary* userInfo = notification.userInfo;
@@ -0,0 +1,53 @@
+//
+//  AVTTabbedWindows - AVTContainerWindowPool.h
+//
+//  Copyright (c) 2013 Avatron Software, Inc. All rights reserved.
+//
+
+#import <Cocoa/Cocoa.h>
+
+@class AVTContainerWindowController;
+
+// Building a container window means loading the nib, creating the tab well and toolbar controllers and laying them out, which
+// is most of the time it takes to tear a tab off into its own window. The pool keeps a few of those windows built ahead of time,
+// hidden, so a tear-off only has to move the tab into one.
+//
+// Windows are built per kind, a window controller class paired with a container class, and only for the kinds that have been
+// asked for. The pool refills itself a little after it is drawn on, and never while a mouse button is down, so the building
+// doesn't land in the middle of the drag that needed the window.
+
+@interface AVTContainerWindowPool : NSObject
+
++ (AVTContainerWindowPool*) sharedPool;
+
+// Returns a hidden, empty controller of class |controllerClass| whose container is of class |containerClass|, removing it from
+// the pool, or nil if none is ready. The kind is kept ready from then on.
+
+- (AVTContainerWindowController*) dequeueControllerOfClass: (Class) controllerClass containerClass: (Class) containerClass;
+
+// Start keeping windows of this kind ready, without taking one.
+
+- (void) prepareControllersOfClass: (Class) controllerClass containerClass: (Class) containerClass;
+
+// Release every pooled window. The pool refills on the next request.
+
+- (void) drain;
+
+// Records how long a tear-off took, from the start of the detach to the new window holding the tab.
+
+- (void) noteTearOffDuration: (NSTimeInterval) duration;
+
+// The number of windows kept ready of each kind. Defaults to 1; 0 turns the pool off.
+
+@property (nonatomic, assign) NSUInteger capacity;
+
+// Instrumentation.
+
+@property (nonatomic, readonly) NSUInteger hitCount;                    // Requests answered from the pool.
+@property (nonatomic, readonly) NSUInteger missCount;                   // Requests that found the pool empty.
+@property (nonatomic, readonly) NSUInteger buildCount;                  // Windows built for the pool.
+@property (nonatomic, readonly) NSUInteger tearOffCount;
+@property (nonatomic, readonly) NSTimeInterval lastTearOffDuration;
+@property (nonatomic, readonly) NSTimeInterval longestTearOffDuration;
+
+@end
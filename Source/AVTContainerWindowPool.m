@@ -0,0 +1,185 @@
+//
+//  AVTTabbedWindows - AVTContainerWindowPool.m
+//
+//  Copyright (c) 2013 Avatron Software, Inc. All rights reserved.
+//
+
+#import "AVTContainerWindowPool.h"
+
+#import "AVTContainer.h"
+#import "AVTContainerWindowController.h"
+
+// How long to wait after the pool is drawn on before building a replacement. Long enough for the tear-off that took the window
+// to finish settling.
+
+static const NSTimeInterval kReplenishDelay = 0.5;
+
+static const NSUInteger kDefaultCapacity = 1;
+
+@interface AVTContainerWindowPool()
+
+- (void) scheduleReplenish;
+- (void) replenish;
+- (void) applicationWillTerminate: (NSNotification*) notification;
+
+@property (nonatomic, retain) NSMutableDictionary* pools;   // @[controller class, container class] -> NSMutableArray of controllers.
+@property (nonatomic, assign) NSUInteger hitCount;
+@property (nonatomic, assign) NSUInteger missCount;
+@property (nonatomic, assign) NSUInteger buildCount;
+@property (nonatomic, assign) NSUInteger tearOffCount;
+@property (nonatomic, assign) NSTimeInterval lastTearOffDuration;
+@property (nonatomic, assign) NSTimeInterval longestTearOffDuration;
+
+@end
+
+@implementation AVTContainerWindowPool
+
++ (AVTContainerWindowPool*) sharedPool
+{
+    static AVTContainerWindowPool* sSharedPool = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once( &onceToken, ^{
+        sSharedPool = [[AVTContainerWindowPool alloc] init];
+    } );
+
+    return sSharedPool;
+}
+
+- (id) init
+{
+    self = [super init];
+    if( self != nil )
+    {
+        _capacity = kDefaultCapacity;
+        _pools = [[NSMutableDictionary alloc] init];
+
+        [[NSNotificationCenter defaultCenter] addObserver: self
+                                                 selector: @selector( applicationWillTerminate: )
+                                                     name: NSApplicationWillTerminateNotification
+                                                   object: nil];
+    }
+
+    return self;
+}
+
+- (void) dealloc
+{
+    [NSObject cancelPreviousPerformRequestsWithTarget: self];
+    [[NSNotificationCenter defaultCenter] removeObserver: self];
+
+    [self drain];
+    [_pools release];
+
+    [super dealloc];
+}
+
+- (void) setCapacity: (NSUInteger) capacity
+{
+    _capacity = capacity;
+
+    for( NSMutableArray* ready in [self.pools allValues] )
+    {
+        if( ready.count > capacity )
+            [ready removeObjectsInRange: NSMakeRange( capacity, ready.count - capacity )];
+    }
+
+    [self scheduleReplenish];
+}
+
+- (AVTContainerWindowController*) dequeueControllerOfClass: (Class) controllerClass
+                                            containerClass: (Class) containerClass
+{
+    [self prepareControllersOfClass: controllerClass containerClass: containerClass];
+
+    NSMutableArray* ready = self.pools[@[controllerClass, containerClass]];
+    AVTContainerWindowController* controller = [[[ready lastObject] retain] autorelease];
+    if( controller )
+    {
+        [ready removeLastObject];
+        controller.pooled = NO;
+        self.hitCount++;
+    }
+    else
+    {
+        self.missCount++;
+    }
+
+    return controller;
+}
+
+- (void) prepareControllersOfClass: (Class) controllerClass
+                    containerClass: (Class) containerClass
+{
+    NSArray* kind = @[controllerClass, containerClass];
+    if( self.pools[kind] == nil )
+        self.pools[kind] = [NSMutableArray array];
+
+    [self scheduleReplenish];
+}
+
+- (void) drain
+{
+    for( NSMutableArray* ready in [self.pools allValues] )
+        [ready removeAllObjects];
+}
+
+- (void) noteTearOffDuration: (NSTimeInterval) duration
+{
+    self.tearOffCount++;
+    self.lastTearOffDuration = duration;
+    self.longestTearOffDuration = MAX( self.longestTearOffDuration, duration );
+}
+
+#pragma mark - Private
+
+// Replenishing only runs in the default mode, so it waits out live resizes and modal sessions.
+
+- (void) scheduleReplenish
+{
+    if( self.capacity == 0 )
+        return;
+
+    [NSObject cancelPreviousPerformRequestsWithTarget: self selector: @selector( replenish ) object: nil];
+    [self performSelector: @selector( replenish ) withObject: nil afterDelay: kReplenishDelay inModes: @[NSDefaultRunLoopMode]];
+}
+
+// Builds at most one window per pass so each is a short interruption, and comes back for the next.
+
+- (void) replenish
+{
+    // Tab drags track the mouse in the default mode as well. A button being down means one may be under way, and it will want
+    // the run loop to itself.
+
+    if( [NSEvent pressedMouseButtons] != 0 )
+    {
+        [self scheduleReplenish];
+        return;
+    }
+
+    for( NSArray* kind in self.pools )
+    {
+        NSMutableArray* ready = self.pools[kind];
+        if( ready.count < self.capacity )
+        {
+            Class controllerClass = kind[0];
+            Class containerClass = kind[1];
+
+            AVTContainerWindowController* controller = [[controllerClass alloc] initWithContainer: [containerClass container]];
+            controller.pooled = YES;
+            [ready addObject: controller];
+            [controller release];
+            self.buildCount++;
+
+            [self scheduleReplenish];
+            return;
+        }
+    }
+}
+
+- (void) applicationWillTerminate: (NSNotification*) notification
+{
+    [NSObject cancelPreviousPerformRequestsWithTarget: self selector: @selector( replenish ) object: nil];
+    [self drain];
+}
+
+@end
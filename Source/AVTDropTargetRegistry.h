@@ -0,0 +1,49 @@
+//
+//  AVTTabbedWindows - AVTDropTargetRegistry.h
+//
+//  Copyright (c) 2013 Avatron Software, Inc. All rights reserved.
+//
+
+#import <Cocoa/Cocoa.h>
+
+@class AVTTabWindowController;
+
+// The windows a dragged tab can be dropped into, for the length of one drag. Finding them means walking every window in the
+// application and asking each controller, and the screen position of each tab strip has to be worked out as well, which is too
+// much to do on every mouse event. The registry takes a snapshot of the targets and their screen geometry the first time it's
+// asked and answers point queries from a spatial index over it. The snapshot is retaken lazily after any window other than the
+// dragged one moves, resizes, closes or changes its ordering.
+
+@interface AVTDropTargetRegistry : NSObject
+
+// Returns the controllers that could take a tab from |dragController|, ordered front to back. A window is never a target for
+// itself. This is the uncached query.
+
++ (NSArray*) targetsForDragController: (AVTTabWindowController*) dragController;
+
+- (id) initWithDragController: (AVTTabWindowController*) dragController;
+
+// Returns the frontmost target whose window contains |point| (in screen coordinates), or nil. |inTabWell| is set to whether the
+// point is also over the target's tab strip.
+
+- (AVTTabWindowController*) targetAtPoint: (NSPoint) point inTabWell: (BOOL*) inTabWell;
+
+// Orders |target|'s window to the front of the other targets, unless it already is.
+
+- (void) orderTargetFront: (AVTTabWindowController*) target;
+
+// Discard the snapshot. The next query takes a new one.
+
+- (void) invalidate;
+
+@property (nonatomic, readonly) AVTTabWindowController* dragController;    // Weak
+
+// The targets, front to back.
+
+@property (nonatomic, readonly) NSArray* targets;
+
+// The number of snapshots taken so far.
+
+@property (nonatomic, readonly) NSUInteger snapshotCount;
+
+@end
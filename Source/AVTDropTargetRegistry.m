@@ -0,0 +1,272 @@
+//
+//  AVTTabbedWindows - AVTDropTargetRegistry.m
+//
+//  Copyright (c) 2013 Avatron Software, Inc. All rights reserved.
+//
+
+#import "AVTDropTargetRegistry.h"
+
+#import "AVTTabWellView.h"
+#import "AVTTabWindowController.h"
+
+// The snapshot is indexed by splitting the horizontal extent of all the targets into this many bands. Each band lists the targets
+// overlapping it, so a query only looks at the windows in one band. Windows are mostly wider than they are tall, and side by side
+// more often than stacked, so bands are vertical.
+
+enum { kBandCount = 16 };
+
+typedef struct
+{
+    AVTTabWindowController* controller;     // Retained for the life of the snapshot.
+    NSRect windowFrame;                     // Screen coordinates.
+    NSRect tabWellFrame;                    // Screen coordinates.
+
+} AVTDropTarget;
+
+@interface AVTDropTargetRegistry()
+{
+    AVTDropTarget* _entries;                // Front to back.
+    NSUInteger _entryCount;
+    NSMutableIndexSet* _bands[kBandCount];  // Indexes into |_entries| overlapping each band.
+    CGFloat _bandMinX;
+    CGFloat _bandWidth;
+    BOOL _snapshotValid;
+}
+
+- (void) takeSnapshotIfNeeded;
+- (void) releaseSnapshot;
+- (void) rebuildBands;
+- (void) windowGeometryChanged: (NSNotification*) notification;
+
+@property (nonatomic, assign) AVTTabWindowController* dragController;
+@property (nonatomic, assign) NSUInteger snapshotCount;
+
+@end
+
+@implementation AVTDropTargetRegistry
+
++ (NSArray*) targetsForDragController: (AVTTabWindowController*) dragController
+{
+    NSMutableArray* targets = [NSMutableArray array];
+    NSWindow* dragWindow = [dragController window];
+    for( NSWindow* window in [NSApp orderedWindows] )
+    {
+        if( window == dragWindow )
+            continue;
+        if( ![window isVisible] )
+            continue;
+
+        // Skip windows on the wrong space.
+
+        if( [window respondsToSelector: @selector( isOnActiveSpace )] )
+        {
+            if( ![window performSelector: @selector( isOnActiveSpace )] )
+                continue;
+        }
+
+        NSWindowController* controller = [window windowController];
+        if( [controller isKindOfClass: [AVTTabWindowController class]] )
+        {
+            AVTTabWindowController* realController = (AVTTabWindowController*)controller;
+            if( [realController canReceiveFrom: dragController] )
+                [targets addObject: controller];
+        }
+    }
+    return targets;
+}
+
+- (id) initWithDragController: (AVTTabWindowController*) dragController
+{
+    self = [super init];
+    if( self != nil )
+    {
+        _dragController = dragController;
+
+        for( NSUInteger i = 0; i < kBandCount; ++i )
+            _bands[i] = [[NSMutableIndexSet alloc] init];
+
+        // Window ordering has no notification of its own; a window becoming key or main is what usually brings it forward.
+
+        NSArray* names = @[NSWindowDidMoveNotification,
+                           NSWindowDidResizeNotification,
+                           NSWindowWillCloseNotification,
+                           NSWindowDidMiniaturizeNotification,
+                           NSWindowDidDeminiaturizeNotification,
+                           NSWindowDidChangeScreenNotification,
+                           NSWindowDidBecomeKeyNotification,
+                           NSWindowDidBecomeMainNotification];
+        for( NSString* name in names )
+        {
+            [[NSNotificationCenter defaultCenter] addObserver: self
+                                                     selector: @selector( windowGeometryChanged: )
+                                                         name: name
+                                                       object: nil];
+        }
+        [[[NSWorkspace sharedWorkspace] notificationCenter] addObserver: self
+                                                               selector: @selector( windowGeometryChanged: )
+                                                                   name: NSWorkspaceActiveSpaceDidChangeNotification
+                                                                 object: nil];
+    }
+
+    return self;
+}
+
+- (void) dealloc
+{
+    [[NSNotificationCenter defaultCenter] removeObserver: self];
+    [[[NSWorkspace sharedWorkspace] notificationCenter] removeObserver: self];
+
+    [self releaseSnapshot];
+    free( _entries );
+
+    for( NSUInteger i = 0; i < kBandCount; ++i )
+        [_bands[i] release];
+
+    [super dealloc];
+}
+
+- (NSArray*) targets
+{
+    [self takeSnapshotIfNeeded];
+
+    NSMutableArray* targets = [NSMutableArray arrayWithCapacity: _entryCount];
+    for( NSUInteger i = 0; i < _entryCount; ++i )
+        [targets addObject: _entries[i].controller];
+
+    return targets;
+}
+
+- (AVTTabWindowController*) targetAtPoint: (NSPoint) point
+                                inTabWell: (BOOL*) inTabWell
+{
+    [self takeSnapshotIfNeeded];
+
+    if( inTabWell )
+        *inTabWell = NO;
+
+    if( _entryCount == 0 || point.x < _bandMinX || point.x >= _bandMinX + _bandWidth * kBandCount )
+        return nil;
+
+    NSUInteger band = MIN( (NSUInteger)((point.x - _bandMinX) / _bandWidth), kBandCount - 1 );
+
+    // Indexes are in front to back order, so the first window containing the point is the one on top.
+
+    NSUInteger index = [_bands[band] firstIndex];
+    for( ; index != NSNotFound; index = [_bands[band] indexGreaterThanIndex: index] )
+    {
+        const AVTDropTarget* entry = &_entries[index];
+        if( NSPointInRect( point, entry->windowFrame ) )
+        {
+            if( inTabWell )
+                *inTabWell = NSPointInRect( point, entry->tabWellFrame );
+
+            return entry->controller;
+        }
+    }
+
+    return nil;
+}
+
+- (void) orderTargetFront: (AVTTabWindowController*) target
+{
+    [self takeSnapshotIfNeeded];
+
+    NSUInteger index = 0;
+    while( index < _entryCount && _entries[index].controller != target )
+        ++index;
+
+    if( index == 0 || index == _entryCount )
+        return;
+
+    [[target window] orderFront: self];
+
+    // Ordering a window front posts nothing, so keep the snapshot's order in step by hand.
+
+    AVTDropTarget entry = _entries[index];
+    memmove( &_entries[1], &_entries[0], index * sizeof( AVTDropTarget ) );
+    _entries[0] = entry;
+    [self rebuildBands];
+}
+
+- (void) invalidate
+{
+    _snapshotValid = NO;
+}
+
+#pragma mark - Private
+
+- (void) takeSnapshotIfNeeded
+{
+    if( _snapshotValid )
+        return;
+
+    [self releaseSnapshot];
+
+    NSArray* targets = [[self class] targetsForDragController: self.dragController];
+    _entries = realloc( _entries, MAX( targets.count, (NSUInteger)1 ) * sizeof( AVTDropTarget ) );
+    for( AVTTabWindowController* target in targets )
+    {
+        AVTDropTarget* entry = &_entries[_entryCount++];
+        entry->controller = [target retain];
+        entry->windowFrame = target.window.frame;
+
+        NSRect tabWellFrame = target.tabWellView.frame;
+        tabWellFrame.origin = [target.window convertBaseToScreen: tabWellFrame.origin];
+        entry->tabWellFrame = tabWellFrame;
+    }
+
+    [self rebuildBands];
+
+    _snapshotValid = YES;
+    self.snapshotCount++;
+}
+
+- (void) releaseSnapshot
+{
+    for( NSUInteger i = 0; i < _entryCount; ++i )
+        [_entries[i].controller release];
+    _entryCount = 0;
+}
+
+- (void) rebuildBands
+{
+    for( NSUInteger i = 0; i < kBandCount; ++i )
+        [_bands[i] removeAllIndexes];
+
+    if( _entryCount == 0 )
+        return;
+
+    NSRect bounds = _entries[0].windowFrame;
+    for( NSUInteger i = 1; i < _entryCount; ++i )
+        bounds = NSUnionRect( bounds, _entries[i].windowFrame );
+
+    _bandMinX = NSMinX( bounds );
+    _bandWidth = MAX( NSWidth( bounds ) / kBandCount, 1 );
+
+    for( NSUInteger i = 0; i < _entryCount; ++i )
+    {
+        const NSRect frame = _entries[i].windowFrame;
+        NSUInteger first = (NSUInteger)((NSMinX( frame ) - _bandMinX) / _bandWidth);
+        NSUInteger last = (NSUInteger)((NSMaxX( frame ) - _bandMinX) / _bandWidth);
+        for( NSUInteger band = first; band <= MIN( last, kBandCount - 1 ); ++band )
+            [_bands[band] addIndex: i];
+    }
+}
+
+// The dragged window (and its overlay, a child window) moves with every mouse event and is never a target, so it doesn't
+// invalidate anything.
+
+- (void) windowGeometryChanged: (NSNotification*) notification
+{
+    NSWindow* dragWindow = [self.dragController window];
+    id object = [notification object];
+    if( dragWindow && [object isKindOfClass: [NSWindow class]] )
+    {
+        if( object == dragWindow || [object parentWindow] == dragWindow )
+            return;
+    }
+
+    [self invalidate];
+}
+
+@end
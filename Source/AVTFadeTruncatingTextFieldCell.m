@@ -17,10 +17,55 @@
 
 #import "AVTFadeTruncatingTextFieldCell.h"
 
+#import "AVTBitmapCache.h"
+
 #if MAC_OS_X_VERSION_MIN_REQUIRED >= MAC_OS_X_VERSION_10_5
 
+static NSMutableDictionary* sMasks = nil;       // Text color -> NSGradient.
+
+@interface AVTFadeTruncatingTextFieldCell()
+
+@property (nonatomic, copy) NSAttributedString* measuredString;     // The string |measuredSize| is for.
+@property (nonatomic, assign) NSSize measuredSize;
+
+// The faded end of the title, kept as a bitmap by each cell. Titles change rarely but tabs redraw all the time while hovering,
+// glowing and animating, and every tab has a title of its own, so a cache shared between cells would only be thrashed by a
+// strip of many tabs. |fadeString| is the measured string the image was drawn for and is compared by identity, as a new one
+// is only measured when the title changes.
+
+@property (nonatomic, assign) CGImageRef fadeImage;                 // Owned.
+@property (nonatomic, retain) NSAttributedString* fadeString;
+@property (nonatomic, retain) NSColor* fadeColor;
+@property (nonatomic, assign) NSSize fadeCellSize;
+@property (nonatomic, assign) NSSize fadeSize;
+@property (nonatomic, assign) BOOL fadeFlipped;
+@property (nonatomic, assign) CGFloat fadeScale;
+
+- (NSSize) titleSize;
+- (void) setFadeImage: (CGImageRef) fadeImage
+{
+    if( _fadeImage != fadeImage )
+    {
+        CGImageRelease( _fadeImage );
+        _fadeImage = CGImageRetain( fadeImage );
+    }
+}
+
+- (NSGradient*) maskForColor: (NSColor*) color;
+- (void) drawFadeInRect: (NSRect) gradientPart cellFrame: (NSRect) cellFrame inView: (NSView*) controlView;
+
+@end
+
 @implementation AVTFadeTruncatingTextFieldCell
 
++ (void) initialize
+{
+    if( self == [AVTFadeTruncatingTextFieldCell class] )
+    {
+        sMasks = [[NSMutableDictionary alloc] init];
+    }
+}
+
 - (void) awakeFromNib
 {
     // Force to clipping
@@ -39,10 +84,34 @@
     return self;
 }
 
+- (void) dealloc
+{
+    [_measuredString release];
+    [_fadeString release];
+    [_fadeColor release];
+    CGImageRelease( _fadeImage );
+
+    [super dealloc];
+}
+
+- (id) copyWithZone: (NSZone*) zone
+{
+    AVTFadeTruncatingTextFieldCell* copy = [super copyWithZone: zone];
+
+    // NSCell copies ivars bitwise, so take our own references to the measured string and the faded end.
+
+    copy->_measuredString = [_measuredString copy];
+    copy->_fadeString = [_fadeString retain];
+    copy->_fadeColor = [_fadeColor retain];
+    CGImageRetain( _fadeImage );
+
+    return copy;
+}
+
 - (void) drawInteriorWithFrame: (NSRect) cellFrame
                         inView: (NSView*) controlView
 {
-    NSSize size = [[self attributedStringValue] size];
+    NSSize size = [self titleSize];
 
     // Don't complicate drawing unless we need to clip
 
@@ -67,35 +136,110 @@
         [super drawInteriorWithFrame: cellFrame inView: controlView];
         [[NSGraphicsContext currentContext] restoreGraphicsState];
 
-        // Draw the gradient part with a transparency layer. This makes the text look
-        // suboptimal, but since it fades out, that's ok.
+        // Draw the gradient part from a bitmap of the text with the mask already applied. This makes the text look
+        // suboptimal, as a transparency layer would, but since it fades out, that's ok.
 
-        [[NSGraphicsContext currentContext] saveGraphicsState];
-        [NSBezierPath clipRect: gradientPart];
-        CGContextRef context = [[NSGraphicsContext currentContext] graphicsPort];
-        CGContextBeginTransparencyLayerWithRect( context, NSRectToCGRect( gradientPart ), 0 );
+        [self drawFadeInRect: gradientPart cellFrame: cellFrame inView: controlView];
+    }
+}
 
-        [super drawInteriorWithFrame: cellFrame inView: controlView];
+// Measuring lays the title out, so the size is only measured again when the string or its attributes change.
+
+- (NSSize) titleSize
+{
+    NSAttributedString* string = [self attributedStringValue];
+    if( ![string isEqualToAttributedString: self.measuredString] )
+    {
+        self.measuredString = string;
+        self.measuredSize = [string size];
+    }
 
+    return self.measuredSize;
+}
+
+- (void) setFadeImage: (CGImageRef) fadeImage
+{
+    if( _fadeImage != fadeImage )
+    {
+        CGImageRelease( _fadeImage );
+        _fadeImage = CGImageRetain( fadeImage );
+    }
+}
+
+- (NSGradient*) maskForColor: (NSColor*) color
+{
+    NSGradient* mask = sMasks[color];
+    if( mask == nil )
+    {
         // TODO(alcor): switch this to GTMLinearRGBShading if we ever need on 10.4
 
-        NSColor* color = [self textColor];
         NSColor* alphaColor = [color colorWithAlphaComponent: 0.0];
-        NSGradient* mask = [[NSGradient alloc] initWithStartingColor: color
-                                                         endingColor: alphaColor];
-
-        // Draw the gradient mask
-
-        CGContextSetBlendMode( context, kCGBlendModeDestinationIn );
-        [mask drawFromPoint: NSMakePoint( NSMaxX( cellFrame ) - gradientWidth,
-                                          NSMinY( cellFrame ) )
-                    toPoint: NSMakePoint( NSMaxX( cellFrame ),
-                               NSMinY( cellFrame ) )
-                    options: NSGradientDrawsBeforeStartingLocation];
-        [mask release];
-        CGContextEndTransparencyLayer( context );
-        [[NSGraphicsContext currentContext] restoreGraphicsState];
+        mask = [[[NSGradient alloc] initWithStartingColor: color endingColor: alphaColor] autorelease];
+        sMasks[color] = mask;
     }
+
+    return mask;
+}
+
+- (void) drawFadeInRect: (NSRect) gradientPart
+              cellFrame: (NSRect) cellFrame
+                 inView: (NSView*) controlView
+{
+    NSColor* color = [self textColor];
+    BOOL flipped = [controlView isFlipped];
+    CGFloat scale = [controlView window] ? [[controlView window] backingScaleFactor] : 1.0f;
+
+    // Draw the faded end again only if something it looks like changed. The text is drawn at the same offset within the bitmap
+    // for any cell origin, so the origin is left out.
+
+    BOOL current = self.fadeImage != NULL &&
+                   self.fadeString == self.measuredString &&
+                   [self.fadeColor isEqual: color] &&
+                   NSEqualSizes( self.fadeCellSize, cellFrame.size ) &&
+                   NSEqualSizes( self.fadeSize, gradientPart.size ) &&
+                   self.fadeFlipped == flipped &&
+                   self.fadeScale == scale;
+
+    if( !current )
+    {
+        CGImageRef image = AVTCreateBitmap( gradientPart.size, scale, ^{
+            NSGraphicsContext* graphicsContext = [NSGraphicsContext currentContext];
+            CGContextRef context = [graphicsContext graphicsPort];
+
+            // Lay the text out as the control view would, and move the gradient part to the bitmap's origin.
+
+            if( flipped )
+            {
+                CGContextTranslateCTM( context, 0, NSHeight( gradientPart ) );
+                CGContextScaleCTM( context, 1, -1 );
+                [NSGraphicsContext setCurrentContext: [NSGraphicsContext graphicsContextWithGraphicsPort: context flipped: YES]];
+            }
+
+            CGContextTranslateCTM( context, -NSMinX( gradientPart ), -NSMinY( gradientPart ) );
+
+            [super drawInteriorWithFrame: cellFrame inView: controlView];
+
+            // Draw the gradient mask
+
+            CGContextSetBlendMode( context, kCGBlendModeDestinationIn );
+            [[self maskForColor: color] drawFromPoint: NSMakePoint( NSMaxX( cellFrame ) - NSWidth( gradientPart ),
+                                                                    NSMinY( cellFrame ) )
+                                              toPoint: NSMakePoint( NSMaxX( cellFrame ),
+                                                                    NSMinY( cellFrame ) )
+                                              options: NSGradientDrawsBeforeStartingLocation];
+        } );
+
+        self.fadeImage = image;
+        self.fadeString = self.measuredString;
+        self.fadeColor = color;
+        self.fadeCellSize = cellFrame.size;
+        self.fadeSize = gradientPart.size;
+        self.fadeFlipped = flipped;
+        self.fadeScale = scale;
+        CGImageRelease( image );
+    }
+
+    AVTDrawBitmap( self.fadeImage, gradientPart );
 }
 
 @end
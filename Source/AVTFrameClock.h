@@ -0,0 +1,76 @@
+//
+//  AVTTabbedWindows - AVTFrameClock.h
+//
+//  Copyright (c) 2013 Avatron Software, Inc. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+// Returns the current time in seconds. Only differences between values are meaningful.
+
+typedef NSTimeInterval (^AVTTimeSource)( void );
+
+@class AVTFrameClock;
+
+// Something that is animated by a frame clock.
+
+@protocol AVTFrameClockClient <NSObject>
+
+// Called once per frame while the client is active. |time| is the same for every client ticked in a given frame.
+// Return NO once there is nothing left to animate; the client is then deactivated until it activates itself again.
+
+- (BOOL) frameClock: (AVTFrameClock*) clock tickAtTime: (NSTimeInterval) time;
+
+@end
+
+// A frame clock delivers ticks to any number of clients from a single timer, |interval| seconds apart. The timer only runs while
+// at least one client is active, so an idle clock costs nothing. Clients are not retained and must deactivate themselves before
+// they go away.
+//
+// The clock reads the time from its |timeSource|. Clocks created with a custom time source and |automatic| set to NO never
+// schedule a timer; the owner advances them by calling |-tick|, which is how the animation code can be driven headlessly.
+
+@interface AVTFrameClock : NSObject
+
+// The clock shared by the framework's animations. It reads the media clock and is driven by a display link rather than a timer,
+// so it ticks once per refresh of the main display, delivered on the main thread. Its |interval| is the display's refresh period
+// when the clock last started. Frames the main thread is too busy to take are dropped, not queued.
+
++ (AVTFrameClock*) sharedClock;
+
+// Returns a time source reading CACurrentMediaTime().
+
++ (AVTTimeSource) mediaTimeSource;
+
+- (id) initWithInterval: (NSTimeInterval) interval timeSource: (AVTTimeSource) timeSource;
+
+- (void) activateClient: (id<AVTFrameClockClient>) client;
+- (void) deactivateClient: (id<AVTFrameClockClient>) client;
+- (BOOL) isClientActive: (id<AVTFrameClockClient>) client;
+
+// Deliver a frame to every active client now.
+
+- (void) tick;
+
+// The current time according to the time source.
+
+@property (nonatomic, readonly) NSTimeInterval now;
+
+// Seconds between ticks.
+
+@property (nonatomic, readonly) NSTimeInterval interval;
+@property (nonatomic, readonly, copy) AVTTimeSource timeSource;
+
+// If YES (the default) the clock schedules its own timer while it has active clients.
+
+@property (nonatomic, assign) BOOL automatic;
+
+// YES while the timer or display link is running.
+
+@property (nonatomic, readonly, getter=isRunning) BOOL running;
+
+// Number of frames delivered so far.
+
+@property (nonatomic, readonly) NSUInteger tickCount;
+
+@end
@@ -0,0 +1,241 @@
+//
+//  AVTTabbedWindows - AVTFrameClock.m
+//
+//  Copyright (c) 2013 Avatron Software, Inc. All rights reserved.
+//
+
+#import "AVTFrameClock.h"
+
+#import <libkern/OSAtomic.h>
+#import <QuartzCore/QuartzCore.h>
+
+// Interval of the shared clock when the display doesn't report its refresh period.
+
+static const NSTimeInterval kDefaultDisplayInterval = 1.0 / 60.0;
+
+static CVReturn AVTDisplayLinkOutput( CVDisplayLinkRef displayLink, const CVTimeStamp* now, const CVTimeStamp* outputTime, CVOptionFlags flagsIn, CVOptionFlags* flagsOut, void* context );
+
+@interface AVTFrameClock()
+
+- (id) initSynchronizedToDisplayWithTimeSource: (AVTTimeSource) timeSource;
+
+- (void) startTimerIfNeeded;
+- (void) stopTimerIfIdle;
+- (void) timerFired: (NSTimer*) timer;
+- (void) displayLinkFired;
+
+@property (nonatomic, retain) NSHashTable* clients;     // Not retained, see |-activateClient:|.
+@property (nonatomic, retain) NSTimer* timer;
+@property (nonatomic, assign) NSUInteger tickCount;
+@property (nonatomic, assign) NSTimeInterval interval;
+@property (nonatomic, assign) BOOL displayLinkRunning;
+
+@end
+
+@implementation AVTFrameClock
+{
+    CVDisplayLinkRef _displayLink;      // Only for a clock synchronized to the display.
+    volatile int32_t _framePending;     // Set from the display link's thread while a frame waits for the main thread.
+}
+
++ (AVTFrameClock*) sharedClock
+{
+    static AVTFrameClock* sSharedClock = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once( &onceToken, ^{
+        sSharedClock = [[AVTFrameClock alloc] initSynchronizedToDisplayWithTimeSource: [AVTFrameClock mediaTimeSource]];
+    } );
+
+    return sSharedClock;
+}
+
++ (AVTTimeSource) mediaTimeSource
+{
+    return [[^NSTimeInterval( void ) { return CACurrentMediaTime(); } copy] autorelease];
+}
+
+- (id) initWithInterval: (NSTimeInterval) interval
+             timeSource: (AVTTimeSource) timeSource
+{
+    self = [super init];
+    if( self != nil )
+    {
+        NSAssert( interval > 0 && timeSource, @"A frame clock needs an interval and a time source." );
+
+        _interval = interval;
+        _timeSource = [timeSource copy];
+        _automatic = YES;
+        _clients = [[NSHashTable alloc] initWithOptions: NSPointerFunctionsOpaqueMemory | NSPointerFunctionsObjectPointerPersonality capacity: 0];
+    }
+
+    return self;
+}
+
+// Ticks come from a display link on the main display rather than from a timer. Falls back to a timer at the default interval if
+// there is no display link to be had.
+
+- (id) initSynchronizedToDisplayWithTimeSource: (AVTTimeSource) timeSource
+{
+    self = [self initWithInterval: kDefaultDisplayInterval timeSource: timeSource];
+    if( self != nil )
+    {
+        if( CVDisplayLinkCreateWithCGDisplay( CGMainDisplayID(), &_displayLink ) == kCVReturnSuccess )
+            CVDisplayLinkSetOutputCallback( _displayLink, AVTDisplayLinkOutput, self );
+        else
+            _displayLink = NULL;
+    }
+
+    return self;
+}
+
+- (void) dealloc
+{
+    if( _displayLink )
+    {
+        CVDisplayLinkStop( _displayLink );
+        CVDisplayLinkRelease( _displayLink );
+    }
+
+    [_timer invalidate];
+    [_timer release];
+    [_clients release];
+    [_timeSource release];
+
+    [super dealloc];
+}
+
+- (NSTimeInterval) now
+{
+    return self.timeSource();
+}
+
+- (void) setAutomatic: (BOOL) automatic
+{
+    if( _automatic != automatic )
+    {
+        _automatic = automatic;
+        if( _automatic )
+            [self startTimerIfNeeded];
+        else
+            [self stopTimerIfIdle];
+    }
+}
+
+- (BOOL) isRunning
+{
+    return self.timer != nil || self.displayLinkRunning;
+}
+
+#pragma mark - Clients
+
+- (void) activateClient: (id<AVTFrameClockClient>) client
+{
+    NSAssert( [NSThread isMainThread], @"Frame clocks are main thread only." );
+
+    [self.clients addObject: client];
+    [self startTimerIfNeeded];
+}
+
+- (void) deactivateClient: (id<AVTFrameClockClient>) client
+{
+    [self.clients removeObject: client];
+    [self stopTimerIfIdle];
+}
+
+- (BOOL) isClientActive: (id<AVTFrameClockClient>) client
+{
+    return [self.clients containsObject: client];
+}
+
+#pragma mark - Ticking
+
+// Clients may activate and deactivate clients (including themselves) from their tick, so walk a snapshot and skip anything that
+// was deactivated along the way. A client activated during the frame gets its first tick on the next one.
+
+- (void) tick
+{
+    NSAssert( [NSThread isMainThread], @"Frame clocks are main thread only." );
+
+    self.tickCount++;
+
+    NSTimeInterval time = self.now;
+    for( id<AVTFrameClockClient> client in [self.clients allObjects] )
+    {
+        if( ![self.clients containsObject: client] )
+            continue;
+
+        if( ![client frameClock: self tickAtTime: time] )
+            [self.clients removeObject: client];
+    }
+
+    [self stopTimerIfIdle];
+}
+
+- (void) startTimerIfNeeded
+{
+    if( !self.automatic || self.isRunning || self.clients.count == 0 )
+        return;
+
+    if( _displayLink )
+    {
+        // The main display may have changed since the last run.
+
+        CVDisplayLinkSetCurrentCGDisplay( _displayLink, CGMainDisplayID() );
+        CVTime period = CVDisplayLinkGetNominalOutputVideoRefreshPeriod( _displayLink );
+        if( !(period.flags & kCVTimeIsIndefinite) && period.timeValue > 0 )
+            self.interval = (NSTimeInterval)period.timeValue / period.timeScale;
+
+        self.displayLinkRunning = CVDisplayLinkStart( _displayLink ) == kCVReturnSuccess;
+    }
+
+    if( !self.displayLinkRunning )
+    {
+        // Scheduled in the common modes so animations keep running during live resize and mouse tracking.
+
+        self.timer = [NSTimer timerWithTimeInterval: self.interval target: self selector: @selector( timerFired: ) userInfo: nil repeats: YES];
+        [[NSRunLoop currentRunLoop] addTimer: self.timer forMode: NSRunLoopCommonModes];
+    }
+}
+
+- (void) stopTimerIfIdle
+{
+    if( self.automatic && self.clients.count )
+        return;
+
+    if( self.displayLinkRunning )
+    {
+        CVDisplayLinkStop( _displayLink );
+        self.displayLinkRunning = NO;
+    }
+
+    [self.timer invalidate];
+    self.timer = nil;
+}
+
+- (void) timerFired: (NSTimer*) timer
+{
+    [self tick];
+}
+
+// Called on the display link's thread. The main queue is served in the common modes, like the timer, so frames keep coming during
+// live resize and mouse tracking. A frame that arrives while the main thread still hasn't taken the last one is dropped.
+
+- (void) displayLinkFired
+{
+    if( OSAtomicCompareAndSwap32Barrier( 0, 1, &_framePending ) )
+    {
+        dispatch_async( dispatch_get_main_queue(), ^{
+            OSAtomicCompareAndSwap32Barrier( 1, 0, &_framePending );
+            if( self.displayLinkRunning )
+                [self tick];
+        } );
+    }
+}
+
+@end
+
+CVReturn AVTDisplayLinkOutput( CVDisplayLinkRef displayLink, const CVTimeStamp* now, const CVTimeStamp* outputTime, CVOptionFlags flagsIn, CVOptionFlags* flagsOut, void* context )
+{
+    [(AVTFrameClock*)context displayLinkFired];
+    return kCVReturnSuccess;
+}
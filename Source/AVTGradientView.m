@@ -8,9 +8,18 @@
 
 #import "AVTGradientView.h"
 
+#import "AVTBitmapCache.h"
+
 const CGFloat kToolbarTopOffset = 12.0f;
 const CGFloat kToolbarMaxHeight = 100.0f;
 
+// The gradient only varies vertically and is positioned relative to the top of the window, so it is rendered once per window
+// height, key state and scale into a one point wide strip as tall as the window, and stretched across whatever is drawn. A
+// couple of window sizes in each state covers normal use; a live resize cycles through the cache.
+
+static const NSUInteger kGradientCacheCapacity = 8;
+
+static AVTBitmapCache* sGradientCache = nil;
 static NSGradient* sGradientFaded = nil;
 static NSGradient* sGradientNotFaded = nil;
 static NSColor* sDefaultColorToolbarStroke = nil;
@@ -22,6 +31,18 @@ static NSGradient* MakeGradient( BOOL faded );
 
 @synthesize showsDivider = _showsDivider;
 
++ (void) initialize
+{
+    if( self == [AVTGradientView class] )
+    {
+        sGradientCache = [[AVTBitmapCache alloc] initWithCapacity: kGradientCacheCapacity];
+        sGradientFaded = MakeGradient( YES );
+        sGradientNotFaded = MakeGradient( NO );
+        sDefaultColorToolbarStroke = [[NSColor colorWithCalibratedWhite: 103.0f / 255.0f alpha: 1.0f] retain];
+        sDefaultColorToolbarStrokeInactive = [[NSColor colorWithCalibratedWhite: 123.0f / 255.0f alpha: 1.0f] retain];
+    }
+}
+
 - (id) initWithFrame: (NSRect) frameRect
 {
     self = [super initWithFrame: frameRect];
@@ -47,23 +68,27 @@ static NSGradient* MakeGradient( BOOL faded );
 
 - (void) drawBackground
 {
-    if( sGradientFaded == nil )
-    {
-        sGradientFaded = MakeGradient( YES );
-        sGradientNotFaded = MakeGradient( NO );
-        sDefaultColorToolbarStroke = [[NSColor colorWithCalibratedWhite: 103.0f / 255.0f alpha: 1.0f] retain];
-        sDefaultColorToolbarStrokeInactive = [[NSColor colorWithCalibratedWhite: 123.0f / 255.0f alpha: 1.0f] retain];
-    }
-
-    NSGradient* gradient = self.window.isKeyWindow ? sGradientFaded : sGradientFaded;
+    BOOL keyWindow = self.window.isKeyWindow;
+    NSGradient* gradient = keyWindow ? sGradientNotFaded : sGradientFaded;
     CGFloat winHeight = NSHeight( self.window.frame );
-    NSPoint startPoint = [self convertPoint: NSMakePoint( 0, winHeight - kToolbarTopOffset ) fromView: nil];
-    NSPoint endPoint = NSMakePoint( 0, winHeight - kToolbarTopOffset - kToolbarMaxHeight );
-    endPoint = [self convertPoint: endPoint fromView: nil];
-
-    [gradient drawFromPoint: startPoint
-                    toPoint: endPoint
-                    options: (NSGradientDrawsBeforeStartingLocation | NSGradientDrawsAfterEndingLocation)];
+    CGFloat scale = self.window ? [self.window backingScaleFactor] : 1.0f;
+
+    NSArray* key = @[ @(winHeight), @(keyWindow), @(scale) ];
+    CGImageRef strip = [sGradientCache imageForKey: key
+                                              size: NSMakeSize( 1, winHeight )
+                                             scale: scale
+                                           drawing: ^{
+        [gradient drawFromPoint: NSMakePoint( 0, winHeight - kToolbarTopOffset )
+                        toPoint: NSMakePoint( 0, winHeight - kToolbarTopOffset - kToolbarMaxHeight )
+                        options: (NSGradientDrawsBeforeStartingLocation | NSGradientDrawsAfterEndingLocation)];
+    }];
+
+    // Line the strip up with the window and stretch it across the view.
+
+    NSRect stripRect = [self convertRect: NSMakeRect( 0, 0, 1, winHeight ) fromView: nil];
+    stripRect.origin.x = NSMinX( self.bounds );
+    stripRect.size.width = NSWidth( self.bounds );
+    AVTDrawBitmap( strip, stripRect );
 
     if( self.showsDivider )
     {
@@ -24,4 +24,9 @@ typedef enum
 @property (nonatomic, retain) NSTrackingArea* hoverTrackingArea;
 @property (nonatomic, assign, getter=isTrackingEnabled) BOOL trackingEnabled;
 
+// When YES the button doesn't track the mouse itself and |hoverState| is set by its owner instead. The tab well uses this so
+// that it can drive the hover of every close button from its own tracking area rather than having one per button.
+
+@property (nonatomic, assign) BOOL externalHoverTracking;
+
 @end
@@ -74,7 +74,7 @@
 
 - (void) setTrackingEnabled: (BOOL) enabled
 {
-    if( enabled )
+    if( enabled && !self.externalHoverTracking )
     {
         self.hoverTrackingArea = [[[NSTrackingArea alloc] initWithRect: self.bounds
                                                                options: NSTrackingMouseEnteredAndExited | NSTrackingActiveAlways
@@ -99,10 +99,20 @@
     }
 }
 
+- (void) setExternalHoverTracking: (BOOL) externalHoverTracking
+{
+    _externalHoverTracking = externalHoverTracking;
+    [self setTrackingEnabled: !externalHoverTracking];
+}
+
 - (void) updateTrackingAreas
 {
     [super updateTrackingAreas];
-    [self checkImageState];
+
+    // With external tracking the owner keeps the hover state up to date as the button moves around.
+
+    if( !self.externalHoverTracking )
+        [self checkImageState];
 }
 
 - (void) checkImageState
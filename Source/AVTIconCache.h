@@ -0,0 +1,50 @@
+//
+//  AVTTabbedWindows - AVTIconCache.h
+//
+//  Copyright (c) 2013 Avatron Software, Inc. All rights reserved.
+//
+
+#import <Cocoa/Cocoa.h>
+
+// Called on the main thread with the rasterized icon once it is ready.
+
+typedef void (^AVTIconCacheCompletion)( NSImage* icon );
+
+// Tab icons arrive at whatever size the document has to hand, often a 32 or 64 pixel favicon or a multi-representation file
+// icon, and drawing one of those scaled down into a tab costs far more than drawing a bitmap of the right size. The cache keeps
+// icons rasterized at exactly |kIconWidthAndHeight| points for a given backing scale, so every tab showing the same image at the
+// same scale shares one small bitmap.
+//
+// Entries are keyed by the identity of the source image (not its contents) and the backing scale. The source image is only kept
+// alive while it is being rasterized, on a background queue; until that finishes callers show the source image. The cache holds
+// at most |byteBudget| bytes of icons and evicts the least recently used beyond that. A source that can't be rasterized is kept
+// as its own icon and counted at its full size.
+
+@interface AVTIconCache : NSObject
+
+// The cache shared by every tab well.
+
++ (AVTIconCache*) sharedCache;
+
+- (id) initWithByteBudget: (NSUInteger) byteBudget;
+
+// Returns the icon for |image| at |scale| if it is ready. Otherwise returns nil, starts rasterizing it if that isn't already
+// under way, and calls |completion| (if not nil) once it is ready.
+
+- (NSImage*) iconForImage: (NSImage*) image backingScale: (CGFloat) scale completion: (AVTIconCacheCompletion) completion;
+
+// Drops every icon that is ready. Icons still being rasterized are kept for the callers waiting on them.
+
+- (void) removeAllIcons;
+
+@property (nonatomic, assign) NSUInteger byteBudget;
+
+// Instrumentation.
+
+@property (nonatomic, readonly) NSUInteger byteCount;                   // Bytes of icons currently held.
+@property (nonatomic, readonly) NSUInteger iconCount;
+@property (nonatomic, readonly) NSUInteger hitCount;
+@property (nonatomic, readonly) NSUInteger missCount;
+@property (nonatomic, readonly) NSUInteger evictionCount;
+
+@end
@@ -0,0 +1,337 @@
+//
+//  AVTTabbedWindows - AVTIconCache.m
+//
+//  Copyright (c) 2013 Avatron Software, Inc. All rights reserved.
+//
+
+#import "AVTIconCache.h"
+
+#import <objc/runtime.h>
+
+#import "AVTTabWellController.h"
+
+// Enough for a thousand or so Retina icons.
+
+static const NSUInteger kSharedByteBudget = 4 * 1024 * 1024;
+
+// Each source image is given a token that lives as long as the image does, and entries are keyed by the token. The cache keeps
+// the token alive, not the image, so a stale entry can't be mistaken for a new image that happens to reuse the old one's address.
+
+static char kIconTokenKey;
+
+// One image at one scale. Until the bitmap is ready |icon| is nil, |image| holds the source for rasterizing and |completions|
+// collects everyone waiting for it.
+
+@interface AVTIconCacheEntry : NSObject
+
+@property (nonatomic, retain) id token;
+@property (nonatomic, retain) NSImage* image;
+@property (nonatomic, assign) CGFloat scale;
+@property (nonatomic, retain) NSImage* icon;
+@property (nonatomic, assign) NSUInteger byteCost;
+@property (nonatomic, assign) NSUInteger lastUse;
+@property (nonatomic, retain) NSMutableArray* completions;
+
+@end
+
+@interface AVTIconCache()
+{
+    dispatch_queue_t _queue;
+    NSUInteger _useClock;
+}
+
+- (id) tokenForImage: (NSImage*) image;
+- (AVTIconCacheEntry*) entryForToken: (id) token scale: (CGFloat) scale;
+- (void) rasterizeEntry: (AVTIconCacheEntry*) entry;
+- (void) entry: (AVTIconCacheEntry*) entry didRasterizeImage: (CGImageRef) bitmap;
+- (void) removeEntry: (AVTIconCacheEntry*) entry;
+- (void) evictIfNeeded;
+
+@property (nonatomic, retain) NSMapTable* entries;          // Image token -> NSMutableDictionary of scale -> AVTIconCacheEntry.
+@property (nonatomic, assign) NSUInteger byteCount;
+@property (nonatomic, assign) NSUInteger iconCount;
+@property (nonatomic, assign) NSUInteger hitCount;
+@property (nonatomic, assign) NSUInteger missCount;
+@property (nonatomic, assign) NSUInteger evictionCount;
+
+@end
+
+static CGImageRef AVTCreateIconBitmap( CGImageRef image, size_t pixels );
+static NSUInteger AVTImageByteCost( NSImage* image, CGFloat scale );
+
+@implementation AVTIconCache
+
++ (AVTIconCache*) sharedCache
+{
+    static AVTIconCache* sSharedCache = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once( &onceToken, ^{
+        sSharedCache = [[AVTIconCache alloc] initWithByteBudget: kSharedByteBudget];
+    } );
+
+    return sSharedCache;
+}
+
+- (id) initWithByteBudget: (NSUInteger) byteBudget
+{
+    self = [super init];
+    if( self != nil )
+    {
+        _byteBudget = byteBudget;
+        _entries = [[NSMapTable alloc] initWithKeyOptions: NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality
+                                             valueOptions: NSPointerFunctionsStrongMemory
+                                                 capacity: 0];
+        _queue = dispatch_queue_create( "com.avatron.tabbedwindows.iconcache", DISPATCH_QUEUE_SERIAL );
+    }
+
+    return self;
+}
+
+- (void) dealloc
+{
+    dispatch_release( _queue );
+    [_entries release];
+
+    [super dealloc];
+}
+
+- (void) setByteBudget: (NSUInteger) byteBudget
+{
+    _byteBudget = byteBudget;
+    [self evictIfNeeded];
+}
+
+- (NSImage*) iconForImage: (NSImage*) image
+             backingScale: (CGFloat) scale
+               completion: (AVTIconCacheCompletion) completion
+{
+    NSAssert( [NSThread isMainThread], @"The icon cache is main thread only." );
+
+    if( image == nil )
+        return nil;
+
+    id token = [self tokenForImage: image];
+    AVTIconCacheEntry* entry = [self entryForToken: token scale: scale];
+    if( entry.icon )
+    {
+        entry.lastUse = ++_useClock;
+        self.hitCount++;
+
+        return entry.icon;
+    }
+
+    self.missCount++;
+
+    if( entry == nil )
+    {
+        NSMutableDictionary* scales = [self.entries objectForKey: token];
+        if( scales == nil )
+        {
+            scales = [NSMutableDictionary dictionary];
+            [self.entries setObject: scales forKey: token];
+        }
+
+        entry = [[[AVTIconCacheEntry alloc] init] autorelease];
+        entry.token = token;
+        entry.image = image;
+        entry.scale = scale;
+        entry.completions = [NSMutableArray array];
+        scales[@(scale)] = entry;
+
+        [self rasterizeEntry: entry];
+    }
+
+    if( completion )
+        [entry.completions addObject: [[completion copy] autorelease]];
+
+    return nil;
+}
+
+- (void) removeAllIcons
+{
+    for( NSMutableDictionary* scales in [[self.entries objectEnumerator] allObjects] )
+    {
+        for( AVTIconCacheEntry* entry in [scales allValues] )
+        {
+            if( entry.icon )
+                [self removeEntry: entry];
+        }
+    }
+}
+
+#pragma mark - Private
+
+- (id) tokenForImage: (NSImage*) image
+{
+    id token = objc_getAssociatedObject( image, &kIconTokenKey );
+    if( token == nil )
+    {
+        token = [[[NSObject alloc] init] autorelease];
+        objc_setAssociatedObject( image, &kIconTokenKey, token, OBJC_ASSOCIATION_RETAIN_NONATOMIC );
+    }
+
+    return token;
+}
+
+- (AVTIconCacheEntry*) entryForToken: (id) token
+                               scale: (CGFloat) scale
+{
+    NSMutableDictionary* scales = [self.entries objectForKey: token];
+    return scales[@(scale)];
+}
+
+// The source has to be turned into a CGImage here: NSImage picks its representation on the main thread. The CGImage is
+// immutable, so the scaling can safely happen off it.
+
+- (void) rasterizeEntry: (AVTIconCacheEntry*) entry
+{
+    size_t pixels = (size_t)ceil( kIconWidthAndHeight * entry.scale );
+    NSRect proposedRect = NSMakeRect( 0, 0, pixels, pixels );
+    CGImageRef source = [entry.image CGImageForProposedRect: &proposedRect context: nil hints: nil];
+    if( source == NULL )
+    {
+        [self entry: entry didRasterizeImage: NULL];
+        return;
+    }
+
+    CGImageRetain( source );
+    dispatch_async( _queue, ^{
+        CGImageRef bitmap = AVTCreateIconBitmap( source, pixels );
+        CGImageRelease( source );
+
+        dispatch_async( dispatch_get_main_queue(), ^{
+            [self entry: entry didRasterizeImage: bitmap];
+            CGImageRelease( bitmap );
+        } );
+    } );
+}
+
+// The source is let go once the bitmap is ready. If the source couldn't be rasterized it stands in for the icon itself, and is
+// counted at the size of its representations so it is evicted like any other entry.
+
+- (void) entry: (AVTIconCacheEntry*) entry
+didRasterizeImage: (CGImageRef) bitmap
+{
+    if( bitmap )
+    {
+        entry.icon = [[[NSImage alloc] initWithCGImage: bitmap size: NSMakeSize( kIconWidthAndHeight, kIconWidthAndHeight )] autorelease];
+        entry.byteCost = CGImageGetBytesPerRow( bitmap ) * CGImageGetHeight( bitmap );
+    }
+    else
+    {
+        entry.icon = entry.image;
+        entry.byteCost = AVTImageByteCost( entry.image, entry.scale );
+    }
+    entry.image = nil;
+    entry.lastUse = ++_useClock;
+
+    NSArray* completions = [[entry.completions retain] autorelease];
+    entry.completions = nil;
+
+    self.byteCount += entry.byteCost;
+    self.iconCount++;
+
+    for( AVTIconCacheCompletion completion in completions )
+        completion( entry.icon );
+
+    [self evictIfNeeded];
+}
+
+- (void) removeEntry: (AVTIconCacheEntry*) entry
+{
+    self.byteCount -= entry.byteCost;
+    self.iconCount--;
+
+    id token = entry.token;
+    NSMutableDictionary* scales = [self.entries objectForKey: token];
+    [scales removeObjectForKey: @(entry.scale)];
+    if( scales.count == 0 )
+        [self.entries removeObjectForKey: token];
+}
+
+- (void) evictIfNeeded
+{
+    if( self.byteCount <= self.byteBudget )
+        return;
+
+    NSMutableArray* ready = [NSMutableArray arrayWithCapacity: self.iconCount];
+    for( NSMutableDictionary* scales in [self.entries objectEnumerator] )
+    {
+        for( AVTIconCacheEntry* entry in [scales objectEnumerator] )
+        {
+            if( entry.icon )
+                [ready addObject: entry];
+        }
+    }
+
+    [ready sortUsingComparator: ^NSComparisonResult( AVTIconCacheEntry* entry1, AVTIconCacheEntry* entry2 ) {
+        if( entry1.lastUse < entry2.lastUse )
+            return NSOrderedAscending;
+        return entry1.lastUse > entry2.lastUse ? NSOrderedDescending : NSOrderedSame;
+    }];
+
+    for( AVTIconCacheEntry* entry in ready )
+    {
+        if( self.byteCount <= self.byteBudget )
+            break;
+
+        [self removeEntry: entry];
+        self.evictionCount++;
+    }
+}
+
+@end
+
+@implementation AVTIconCacheEntry
+
+- (void) dealloc
+{
+    [_token release];
+    [_image release];
+    [_icon release];
+    [_completions release];
+
+    [super dealloc];
+}
+
+@end
+
+// Draws |image| into a |pixels| square bitmap, scaled to fit and centered.
+
+CGImageRef AVTCreateIconBitmap( CGImageRef image, size_t pixels )
+{
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    CGContextRef context = CGBitmapContextCreate( NULL, pixels, pixels, 8, 0, colorSpace, kCGImageAlphaPremultipliedFirst | kCGBitmapByteOrder32Host );
+    CGColorSpaceRelease( colorSpace );
+    if( context == NULL )
+        return NULL;
+
+    CGFloat width = CGImageGetWidth( image );
+    CGFloat height = CGImageGetHeight( image );
+    CGFloat scale = MIN( pixels / width, pixels / height );
+    CGRect rect = CGRectMake( (pixels - width * scale) / 2, (pixels - height * scale) / 2, width * scale, height * scale );
+
+    CGContextSetInterpolationQuality( context, kCGInterpolationHigh );
+    CGContextDrawImage( context, rect, image );
+
+    CGImageRef bitmap = CGBitmapContextCreateImage( context );
+    CGContextRelease( context );
+
+    return bitmap;
+}
+
+// The bytes |image| keeps in memory, roughly: four per pixel of each representation. Representations without pixels, such as
+// PDFs, are counted at their size at |scale|.
+
+NSUInteger AVTImageByteCost( NSImage* image, CGFloat scale )
+{
+    NSUInteger byteCost = 0;
+    for( NSImageRep* rep in [image representations] )
+    {
+        NSInteger width = [rep pixelsWide] > 0 ? [rep pixelsWide] : (NSInteger)ceil( [rep size].width * scale );
+        NSInteger height = [rep pixelsHigh] > 0 ? [rep pixelsHigh] : (NSInteger)ceil( [rep size].height * scale );
+        byteCost += (NSUInteger)width * (NSUInteger)height * 4;
+    }
+
+    return byteCost;
+}
@@ -0,0 +1,63 @@
+//
+//  AVTTabbedWindows - AVTTabAnimationTimeline.h
+//
+//  Copyright (c) 2013 Avatron Software, Inc. All rights reserved.
+//
+
+#import <Cocoa/Cocoa.h>
+
+#import "AVTFrameClock.h"
+
+// Called when a view's animation ends. |finished| is NO if the animation was cancelled or replaced before reaching its target.
+
+typedef void (^AVTTabAnimationCompletion)( BOOL finished );
+
+// Returns the frame |progress| of the way (0 to 1, eased in and out) from |fromFrame| to |toFrame|.
+
+NSRect AVTTabAnimationFrameAtProgress( NSRect fromFrame, NSRect toFrame, CGFloat progress );
+
+// Drives every frame animation in the tab well: tabs sliding into place, rising in when inserted and dropping out when closed,
+// and the new tab button. All animations are advanced together once per frame of the clock and their frames are applied in one
+// batch, so closing (or inserting) many tabs at once costs one timer and one pass, not an animation object per tab.
+//
+// A view has at most one animation. Animating a view that is already animating retargets it from wherever it currently is, and
+// |-setFrame:ofView:| moves a view immediately, cancelling anything in flight.
+
+@interface AVTTabAnimationTimeline : NSObject<AVTFrameClockClient>
+
+- (id) initWithFrameClock: (AVTFrameClock*) clock;
+
+// Animate |view| from its current frame to |frame| over |duration| seconds. |completion| may be nil.
+
+- (void) animateView: (NSView*) view toFrame: (NSRect) frame duration: (NSTimeInterval) duration completion: (AVTTabAnimationCompletion) completion;
+
+// Set the frame of |view| right away, cancelling any animation it has.
+
+- (void) setFrame: (NSRect) frame ofView: (NSView*) view;
+
+// Stop animating |view|, leaving it where it is.
+
+- (void) cancelAnimationForView: (NSView*) view;
+
+- (BOOL) isAnimatingView: (NSView*) view;
+
+// The frame |view| is animating to, or its current frame if it isn't animating.
+
+- (NSRect) targetFrameForView: (NSView*) view;
+
+// Move every animation to where it should be at |time| and apply the frames. Animations that reach their target are removed
+// and their completions called. Normally called by the clock.
+
+- (void) advanceToTime: (NSTimeInterval) time;
+
+// Drop every animation without calling the completions and stop listening to the clock. Called by the owner when it goes away.
+
+- (void) invalidate;
+
+@property (nonatomic, readonly) AVTFrameClock* clock;
+
+// Number of views currently animating.
+
+@property (nonatomic, readonly) NSUInteger animationCount;
+
+@end
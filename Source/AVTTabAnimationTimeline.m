@@ -0,0 +1,218 @@
+//
+//  AVTTabbedWindows - AVTTabAnimationTimeline.m
+//
+//  Copyright (c) 2013 Avatron Software, Inc. All rights reserved.
+//
+
+#import "AVTTabAnimationTimeline.h"
+
+#import <QuartzCore/QuartzCore.h>
+
+// One view's animation.
+
+@interface AVTTabAnimation : NSObject
+
+@property (nonatomic, retain) NSView* view;
+@property (nonatomic, assign) NSRect fromFrame;
+@property (nonatomic, assign) NSRect toFrame;
+@property (nonatomic, assign) NSTimeInterval startTime;
+@property (nonatomic, assign) NSTimeInterval duration;
+@property (nonatomic, copy) AVTTabAnimationCompletion completion;
+
+@end
+
+@interface AVTTabAnimationTimeline()
+
+- (AVTTabAnimation*) detachAnimationForView: (NSView*) view;
+
+@property (nonatomic, retain) AVTFrameClock* clock;
+@property (nonatomic, retain) NSMapTable* animations;   // View -> AVTTabAnimation, keyed by pointer.
+
+@end
+
+@implementation AVTTabAnimationTimeline
+
+- (id) initWithFrameClock: (AVTFrameClock*) clock
+{
+    self = [super init];
+    if( self != nil )
+    {
+        _clock = [clock retain];
+        _animations = [[NSMapTable alloc] initWithKeyOptions: NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality
+                                                valueOptions: NSPointerFunctionsStrongMemory
+                                                    capacity: 0];
+    }
+
+    return self;
+}
+
+- (void) dealloc
+{
+    [_clock deactivateClient: self];
+    [_clock release];
+    [_animations release];
+
+    [super dealloc];
+}
+
+- (NSUInteger) animationCount
+{
+    return self.animations.count;
+}
+
+- (void) animateView: (NSView*) view
+             toFrame: (NSRect) frame
+            duration: (NSTimeInterval) duration
+          completion: (AVTTabAnimationCompletion) completion
+{
+    AVTTabAnimation* replaced = [self detachAnimationForView: view];
+
+    if( duration <= 0 )
+    {
+        [view setFrame: frame];
+        if( completion )
+            completion( YES );
+    }
+    else
+    {
+        AVTTabAnimation* animation = [[AVTTabAnimation alloc] init];
+        animation.view = view;
+        animation.fromFrame = view.frame;
+        animation.toFrame = frame;
+        animation.startTime = self.clock.now;
+        animation.duration = duration;
+        animation.completion = completion;
+        [self.animations setObject: animation forKey: view];
+        [animation release];
+
+        [self.clock activateClient: self];
+    }
+
+    // Tell the owner of a replaced animation last, so it sees the new state if it looks.
+
+    if( replaced.completion )
+        replaced.completion( NO );
+}
+
+- (void) setFrame: (NSRect) frame
+           ofView: (NSView*) view
+{
+    AVTTabAnimation* cancelled = [self detachAnimationForView: view];
+    [view setFrame: frame];
+
+    if( cancelled.completion )
+        cancelled.completion( NO );
+}
+
+- (void) cancelAnimationForView: (NSView*) view
+{
+    AVTTabAnimation* cancelled = [self detachAnimationForView: view];
+    if( cancelled.completion )
+        cancelled.completion( NO );
+}
+
+- (BOOL) isAnimatingView: (NSView*) view
+{
+    return [self.animations objectForKey: view] != nil;
+}
+
+- (NSRect) targetFrameForView: (NSView*) view
+{
+    AVTTabAnimation* animation = [self.animations objectForKey: view];
+    return animation ? animation.toFrame : view.frame;
+}
+
+- (void) advanceToTime: (NSTimeInterval) time
+{
+    if( self.animations.count == 0 )
+        return;
+
+    NSMutableArray* finished = nil;
+
+    // Apply every frame in one transaction with implicit layer animations turned off, the timeline is the only thing animating.
+
+    [CATransaction begin];
+    [CATransaction setDisableActions: YES];
+    for( NSView* view in [[self.animations keyEnumerator] allObjects] )
+    {
+        AVTTabAnimation* animation = [self.animations objectForKey: view];
+        CGFloat progress = (CGFloat)((time - animation.startTime) / animation.duration);
+        if( progress >= 1 )
+        {
+            [view setFrame: animation.toFrame];
+            if( finished == nil )
+                finished = [NSMutableArray array];
+            [finished addObject: animation];
+            [self.animations removeObjectForKey: view];
+        }
+        else
+        {
+            [view setFrame: AVTTabAnimationFrameAtProgress( animation.fromFrame, animation.toFrame, progress )];
+        }
+    }
+    [CATransaction commit];
+
+    // Completions run once the frame is fully applied. They are free to start, change or cancel animations.
+
+    for( AVTTabAnimation* animation in finished )
+    {
+        if( animation.completion )
+            animation.completion( YES );
+    }
+}
+
+- (void) invalidate
+{
+    [self.clock deactivateClient: self];
+    [self.animations removeAllObjects];
+}
+
+#pragma mark - AVTFrameClockClient
+
+- (BOOL) frameClock: (AVTFrameClock*) clock tickAtTime: (NSTimeInterval) time
+{
+    [self advanceToTime: time];
+
+    return self.animations.count != 0;
+}
+
+#pragma mark - Private
+
+// Removes and returns the animation for |view|, or nil. The caller is responsible for calling its completion.
+
+- (AVTTabAnimation*) detachAnimationForView: (NSView*) view
+{
+    AVTTabAnimation* animation = [[[self.animations objectForKey: view] retain] autorelease];
+    if( animation )
+        [self.animations removeObjectForKey: view];
+
+    return animation;
+}
+
+@end
+
+@implementation AVTTabAnimation
+
+- (void) dealloc
+{
+    [_view release];
+    [_completion release];
+
+    [super dealloc];
+}
+
+@end
+
+NSRect AVTTabAnimationFrameAtProgress( NSRect fromFrame, NSRect toFrame, CGFloat progress )
+{
+    progress = MAX( 0, MIN( progress, 1 ) );
+
+    // Smoothstep, close to the default Core Animation ease in / ease out curve the tabs used before.
+
+    CGFloat t = progress * progress * (3 - 2 * progress);
+
+    return NSMakeRect( fromFrame.origin.x + (toFrame.origin.x - fromFrame.origin.x) * t,
+                       fromFrame.origin.y + (toFrame.origin.y - fromFrame.origin.y) * t,
+                       fromFrame.size.width + (toFrame.size.width - fromFrame.size.width) * t,
+                       fromFrame.size.height + (toFrame.size.height - fromFrame.size.height) * t );
+}
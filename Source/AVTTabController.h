@@ -31,6 +31,7 @@ typedef enum
 } AVTTabLoadingState;
 
 @class AVTHoverCloseButton;
+@class AVTTabIconView;
 @class AVTTabView;
 
 @interface AVTTabController : NSViewController
@@ -79,6 +80,11 @@ typedef enum
 // Replace the current icon view with the given view. |iconView| will be resized to the size of the current icon view.
 
 @property (nonatomic, retain) NSView* iconView;
+
+// The icon view this tab keeps for its whole life, created on first use. It is only shown once it has been made the |iconView|.
+
+@property (nonatomic, readonly) AVTTabIconView* tabIconView;
+
 @property (nonatomic, retain) IBOutlet NSTextField* titleView;
 @property (nonatomic, retain) IBOutlet AVTHoverCloseButton* closeButton;
 @property (nonatomic, assign, getter=isIconShowing) BOOL iconShowing;
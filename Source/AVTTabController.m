@@ -19,6 +19,7 @@
 
 #import "AVTTabController.h"
 
+#import "AVTTabIconView.h"
 #import "AVTTabView.h"
 
 static NSString* const kContainerThemeDidChangeNotification = @"ContainerThemeDidChangeNotification";
@@ -31,6 +32,7 @@ static NSString* const kContainerThemeDidChangeNotification = @"ContainerThemeDi
 
 @synthesize iconView = _iconView;
 @synthesize selected = _selected;
+@synthesize tabIconView = _tabIconView;
 
 + (CGFloat) minTabWidth         { return 31.0f; }
 + (CGFloat) minSelectedTabWidth { return 46.0f; }
@@ -88,6 +90,7 @@ static NSString* const kContainerThemeDidChangeNotification = @"ContainerThemeDi
     self.tabView.tabController = nil;
 
     [_closeButton release];
+    [_tabIconView release];
 
     [super dealloc];
 }
@@ -186,6 +189,19 @@ static NSString* const kContainerThemeDidChangeNotification = @"ContainerThemeDi
         [[self view] addSubview: _iconView];
 }
 
+- (AVTTabIconView*) tabIconView
+{
+    if( _tabIconView == nil )
+    {
+        NSRect frame = self.originalIconFrame;
+        if( NSIsEmptyRect( frame ) )
+            frame.size = NSMakeSize( 16.0f, 16.0f );
+        _tabIconView = [[AVTTabIconView alloc] initWithFrame: NSMakeRect( 0, 0, NSWidth( frame ), NSHeight( frame ) )];
+    }
+
+    return _tabIconView;
+}
+
 - (NSString*) toolTip
 {
     return [[self view] toolTip];
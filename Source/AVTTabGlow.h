@@ -0,0 +1,71 @@
+//
+//  AVTTabbedWindows - AVTTabGlow.h
+//
+//  Copyright (c) 2013 Avatron Software, Inc. All rights reserved.
+//
+
+#import <Cocoa/Cocoa.h>
+
+#import "AVTFrameClock.h"
+#import "AVTTabView.h"
+
+// The time in seconds during which each glow rises, holds and falls. The hover glow holds after the mouse leaves.
+
+extern const NSTimeInterval kHoverShowDuration;
+extern const NSTimeInterval kHoverHoldDuration;
+extern const NSTimeInterval kHoverHideDuration;
+extern const NSTimeInterval kAlertShowDuration;
+extern const NSTimeInterval kAlertHoldDuration;
+extern const NSTimeInterval kAlertHideDuration;
+
+// The time between steps of a glow that is rising or falling.
+
+extern const NSTimeInterval kGlowUpdateInterval;
+
+// Returned by |AVTTabGlowStep| when neither glow needs another update.
+
+extern const NSTimeInterval kGlowNoUpdate;
+
+// Everything the hover and alert glows of one tab depend on. Times are in the time base of whatever drives the glow.
+
+typedef struct
+{
+    BOOL mouseInside;
+    CGFloat hoverAlpha;                 // How strong the hover glow is.
+    NSTimeInterval hoverHoldEndTime;    // When the hover glow will begin dimming.
+    AlertState alertState;
+    CGFloat alertAlpha;                 // How strong the alert glow is.
+    NSTimeInterval alertHoldEndTime;    // When the alert glow will begin dimming.
+
+} AVTTabGlowState;
+
+// Advances |state| to |currentTime|, |elapsed| seconds after the previous step. The hover glow rises while the mouse is inside
+// and falls once the hold after it leaves is over. The alert glow rises, holds, then falls, and returns to |eAlertNone| on the
+// step after it reaches zero. Returns the delay until the glow next needs a step, or |kGlowNoUpdate| once both glows have
+// settled.
+
+NSTimeInterval AVTTabGlowStep( AVTTabGlowState* state, NSTimeInterval currentTime, NSTimeInterval elapsed );
+
+// Steps the glows of every tab that has one changing from a single frame clock, instead of each tab rescheduling itself. The
+// animator only listens to the clock while some tab's glow is changing.
+
+@interface AVTTabGlowAnimator : NSObject<AVTFrameClockClient>
+
+// The animator for all tabs, on the shared frame clock.
+
++ (AVTTabGlowAnimator*) sharedAnimator;
+
+- (id) initWithFrameClock: (AVTFrameClock*) clock;
+
+// Step |tabView|'s glow on every frame until it settles. Tabs are not retained and must stop before they go away.
+
+- (void) startAnimatingTabView: (AVTTabView*) tabView;
+- (void) stopAnimatingTabView: (AVTTabView*) tabView;
+
+@property (nonatomic, readonly) AVTFrameClock* clock;
+
+// Number of tabs whose glow is changing.
+
+@property (nonatomic, readonly) NSUInteger animatingCount;
+
+@end
@@ -0,0 +1,192 @@
+//
+//  AVTTabbedWindows - AVTTabGlow.m
+//
+//  Copyright (c) 2013 Avatron Software, Inc. All rights reserved.
+//
+
+#import "AVTTabGlow.h"
+
+// The amount of time in seconds during which each type of glow increases, holds
+// steady, and decreases, respectively.
+
+const NSTimeInterval kHoverShowDuration = 0.20;
+const NSTimeInterval kHoverHoldDuration = 0.02;
+const NSTimeInterval kHoverHideDuration = 0.40;
+const NSTimeInterval kAlertShowDuration = 0.40;
+const NSTimeInterval kAlertHoldDuration = 0.40;
+const NSTimeInterval kAlertHideDuration = 0.40;
+
+// The default time interval in seconds between glow updates (when
+// increasing/decreasing).
+
+const NSTimeInterval kGlowUpdateInterval = 0.025;
+
+// A time interval long enough to represent no update.
+
+const NSTimeInterval kGlowNoUpdate = 1000000;
+
+@interface AVTTabGlowAnimator()
+
+@property (nonatomic, retain) AVTFrameClock* clock;
+@property (nonatomic, retain) NSHashTable* tabViews;    // Not retained, see |-startAnimatingTabView:|.
+
+@end
+
+@implementation AVTTabGlowAnimator
+
++ (AVTTabGlowAnimator*) sharedAnimator
+{
+    static AVTTabGlowAnimator* sSharedAnimator = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once( &onceToken, ^{
+        sSharedAnimator = [[AVTTabGlowAnimator alloc] initWithFrameClock: [AVTFrameClock sharedClock]];
+    } );
+
+    return sSharedAnimator;
+}
+
+- (id) initWithFrameClock: (AVTFrameClock*) clock
+{
+    self = [super init];
+    if( self != nil )
+    {
+        _clock = [clock retain];
+        _tabViews = [[NSHashTable alloc] initWithOptions: NSPointerFunctionsOpaqueMemory | NSPointerFunctionsObjectPointerPersonality capacity: 0];
+    }
+
+    return self;
+}
+
+- (void) dealloc
+{
+    [_clock deactivateClient: self];
+    [_clock release];
+    [_tabViews release];
+
+    [super dealloc];
+}
+
+- (NSUInteger) animatingCount
+{
+    return self.tabViews.count;
+}
+
+- (void) startAnimatingTabView: (AVTTabView*) tabView
+{
+    [self.tabViews addObject: tabView];
+    [self.clock activateClient: self];
+}
+
+- (void) stopAnimatingTabView: (AVTTabView*) tabView
+{
+    [self.tabViews removeObject: tabView];
+    if( self.tabViews.count == 0 )
+        [self.clock deactivateClient: self];
+}
+
+#pragma mark - AVTFrameClockClient
+
+- (BOOL) frameClock: (AVTFrameClock*) clock tickAtTime: (NSTimeInterval) time
+{
+    for( AVTTabView* tabView in [self.tabViews allObjects] )
+    {
+        if( ![tabView advanceGlowToTime: time] )
+            [self.tabViews removeObject: tabView];
+    }
+
+    return self.tabViews.count != 0;
+}
+
+@end
+
+NSTimeInterval AVTTabGlowStep( AVTTabGlowState* state, NSTimeInterval currentTime, NSTimeInterval elapsed )
+{
+    // Time until next update for either glow.
+
+    NSTimeInterval nextUpdate = kGlowNoUpdate;
+
+    if( state->mouseInside )
+    {
+        // Increase hover glow until it's 1.
+
+        if( state->hoverAlpha < 1 )
+        {
+            state->hoverAlpha = MIN( state->hoverAlpha + elapsed / kHoverShowDuration, 1 );
+            nextUpdate = MIN( kGlowUpdateInterval, nextUpdate );
+        }  // Else already 1 (no update needed).
+    }
+    else
+    {
+        if( currentTime >= state->hoverHoldEndTime )
+        {
+            // No longer holding, so decrease hover glow until it's 0.
+
+            if( state->hoverAlpha > 0 )
+            {
+                state->hoverAlpha = MAX( state->hoverAlpha - elapsed / kHoverHideDuration, 0 );
+                nextUpdate = MIN( kGlowUpdateInterval, nextUpdate );
+            }  // Else already 0 (no update needed).
+        }
+        else
+        {
+            // Schedule update for end of hold time.
+
+            nextUpdate = MIN( state->hoverHoldEndTime - currentTime, nextUpdate );
+        }
+    }
+
+    if( state->alertState == eAlertRising )
+    {
+        // Increase alert glow until it's 1 ...
+
+        state->alertAlpha = MIN( state->alertAlpha + elapsed / kAlertShowDuration, 1 );
+
+        // ... and having reached 1, switch to holding.
+
+        if( state->alertAlpha >= 1 )
+        {
+            state->alertState = eAlertHolding;
+            state->alertHoldEndTime = currentTime + kAlertHoldDuration;
+            nextUpdate = MIN( kAlertHoldDuration, nextUpdate );
+        }
+        else
+        {
+            nextUpdate = MIN( kGlowUpdateInterval, nextUpdate );
+        }
+    }
+    else if( state->alertState != eAlertNone )
+    {
+        if( state->alertAlpha > 0 )
+        {
+            if( currentTime >= state->alertHoldEndTime )
+            {
+                // Stop holding, then decrease alert glow (until it's 0).
+
+                if( state->alertState == eAlertHolding )
+                {
+                    state->alertState = eAlertFalling;
+                    nextUpdate = MIN( kGlowUpdateInterval, nextUpdate );
+                }
+                else
+                {
+                    state->alertAlpha = MAX( state->alertAlpha - elapsed / kAlertHideDuration, 0 );
+                    nextUpdate = MIN( kGlowUpdateInterval, nextUpdate );
+                }
+            }
+            else
+            {
+                // Schedule update for end of hold time.
+
+                nextUpdate = MIN( state->alertHoldEndTime - currentTime, nextUpdate );
+            }
+        }
+        else
+        {
+            // Done the alert decay cycle.
+
+            state->alertState = eAlertNone;
+        }
+    }
+
+    return nextUpdate;
+}
@@ -0,0 +1,45 @@
+//
+//  AVTTabbedWindows - AVTTabIconView.h
+//
+//  Copyright (c) 2013 Avatron Software, Inc. All rights reserved.
+//
+
+#import <Cocoa/Cocoa.h>
+
+// What a tab icon view is showing.
+
+typedef enum
+{
+    eTabIconModeNone,
+    eTabIconModeIcon,
+    eTabIconModeThrobber,
+    eTabIconModeCrashed,
+
+} AVTTabIconMode;
+
+// The view in the icon slot of a tab. Each tab keeps one for its whole life and switches it between showing the document's
+// icon, a loading throbber and the crashed animation, instead of building a new view for every change of loading state. Asking
+// it to show what it already shows does nothing, so callers can pass every state update straight through.
+
+@interface AVTTabIconView : NSView
+
+// Show |image| as the tab's icon. The icon is drawn from the shared icon cache once it has been rasterized for the window's
+// backing scale, and from |image| itself until then.
+
+- (void) showIconForImage: (NSImage*) image;
+
+// Show a filmstrip throbber cycling through the frames of |filmstrip|.
+
+- (void) showThrobberWithImage: (NSImage*) filmstrip;
+
+// Animate from |beforeImage| to |afterImage| once, then hold on |afterImage|.
+
+- (void) showCrashedFromImage: (NSImage*) beforeImage toImage: (NSImage*) afterImage;
+
+@property (nonatomic, readonly) AVTTabIconMode mode;
+
+// The image passed to |-showIconForImage:|, the filmstrip or the crashed image, depending on the mode.
+
+@property (nonatomic, readonly) NSImage* sourceImage;
+
+@end
@@ -0,0 +1,132 @@
+//
+//  AVTTabbedWindows - AVTTabIconView.m
+//
+//  Copyright (c) 2013 Avatron Software, Inc. All rights reserved.
+//
+
+#import "AVTTabIconView.h"
+
+#import "AVTIconCache.h"
+#import "AVTThrobberView.h"
+
+@interface AVTTabIconView()
+
+- (void) requestIcon;
+- (void) showSubview: (NSView*) subview;
+
+@property (nonatomic, assign) AVTTabIconMode mode;
+@property (nonatomic, retain) NSImage* sourceImage;
+@property (nonatomic, retain) NSImageView* imageView;           // Created the first time an icon is shown.
+@property (nonatomic, retain) AVTThrobberView* throbberView;    // Created the first time a throbber is shown.
+
+@end
+
+@implementation AVTTabIconView
+
+- (void) dealloc
+{
+    [_sourceImage release];
+    [_imageView release];
+    [_throbberView release];
+
+    [super dealloc];
+}
+
+- (void) showIconForImage: (NSImage*) image
+{
+    if( self.mode == eTabIconModeIcon && self.sourceImage == image )
+        return;
+
+    self.mode = eTabIconModeIcon;
+    self.sourceImage = image;
+
+    if( self.imageView == nil )
+    {
+        self.imageView = [[[NSImageView alloc] initWithFrame: [self bounds]] autorelease];
+        [self.imageView setAutoresizingMask: NSViewWidthSizable | NSViewHeightSizable];
+        [self addSubview: self.imageView];
+    }
+
+    [self requestIcon];
+    [self showSubview: self.imageView];
+}
+
+- (void) showThrobberWithImage: (NSImage*) filmstrip
+{
+    if( self.mode == eTabIconModeThrobber && self.sourceImage == filmstrip )
+        return;
+
+    self.mode = eTabIconModeThrobber;
+    self.sourceImage = filmstrip;
+
+    if( self.throbberView == nil )
+    {
+        self.throbberView = [AVTThrobberView filmstripThrobberViewWithFrame: [self bounds] image: filmstrip];
+        [self.throbberView setAutoresizingMask: NSViewWidthSizable | NSViewHeightSizable];
+        [self addSubview: self.throbberView];
+    }
+    else
+    {
+        [self.throbberView setFilmstripImage: filmstrip];
+    }
+
+    [self showSubview: self.throbberView];
+}
+
+- (void) showCrashedFromImage: (NSImage*) beforeImage
+                      toImage: (NSImage*) afterImage
+{
+    if( self.mode == eTabIconModeCrashed && self.sourceImage == afterImage )
+        return;
+
+    self.mode = eTabIconModeCrashed;
+    self.sourceImage = afterImage;
+
+    if( self.throbberView == nil )
+    {
+        self.throbberView = [AVTThrobberView toastThrobberViewWithFrame: [self bounds] beforeImage: beforeImage afterImage: afterImage];
+        [self.throbberView setAutoresizingMask: NSViewWidthSizable | NSViewHeightSizable];
+        [self addSubview: self.throbberView];
+    }
+    else
+    {
+        [self.throbberView setToastBeforeImage: beforeImage afterImage: afterImage];
+    }
+
+    [self showSubview: self.throbberView];
+}
+
+// Moving to a screen with a different backing scale needs the icon rasterized for that scale.
+
+- (void) viewDidChangeBackingProperties
+{
+    [super viewDidChangeBackingProperties];
+
+    if( self.mode == eTabIconModeIcon )
+        [self requestIcon];
+}
+
+#pragma mark - Private
+
+- (void) requestIcon
+{
+    NSImage* image = self.sourceImage;
+    CGFloat scale = [self window] ? [[self window] backingScaleFactor] : [[NSScreen mainScreen] backingScaleFactor];
+
+    NSImage* icon = [[AVTIconCache sharedCache] iconForImage: image backingScale: scale completion: ^( NSImage* rasterizedIcon ) {
+        if( self.mode == eTabIconModeIcon && self.sourceImage == image )
+            [self.imageView setImage: rasterizedIcon];
+    }];
+
+    [self.imageView setImage: icon ? icon : image];
+}
+
+// Only one of the subviews is visible at a time. The hidden throbber drops out of the animation timer.
+
+- (void) showSubview: (NSView*) subview
+{
+    [self.imageView setHidden: subview != self.imageView];
+    [self.throbberView setHidden: subview != self.throbberView];
+}
+
+@end
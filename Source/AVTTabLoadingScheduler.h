@@ -0,0 +1,76 @@
+//
+//  AVTTabbedWindows - AVTTabLoadingScheduler.h
+//
+//  Copyright (c) 2013 Avatron Software, Inc. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+#import "AVTFrameClock.h"
+
+@class AVTContainer;
+@class AVTTabDocument;
+
+// Returns YES once the load it was handed to has been cancelled.
+
+typedef BOOL (^AVTTabLoadingCancelled)( void );
+
+// The loading work of one document. It runs on a background queue and the load is over when it returns. Long loads should check
+// |isCancelled| now and then and return early once it says YES.
+
+typedef void (^AVTTabLoadingWork)( AVTTabDocument* document, AVTTabLoadingCancelled isCancelled );
+
+// Called on the main thread after the document's loading state has been brought up to date. |finished| is NO if the load was
+// cancelled, before or after it started.
+
+typedef void (^AVTTabLoadingCompletion)( AVTTabDocument* document, BOOL finished );
+
+// Runs the loading work of a container's tab documents, a few at a time, so that restoring hundreds of tabs doesn't have all of
+// them competing at once. Waiting loads start in priority order: the selected tab first, then its neighbours (nearest first),
+// then the rest with the most recently selected first and tabs never selected last, in tab order. Priorities are worked out
+// again whenever the selection changes or tabs are inserted or moved, so selecting a tab that is still waiting starts it next.
+//
+// A document's loading state follows its load: |isWaitingForResponse| while it waits, |isLoading| while its work runs, neither
+// once it is over. The properties are set on the main thread, together once per display frame, and the container is told of
+// each change so the tab's throbber follows.
+//
+// Loads are cancelled when their tab closes, is detached (it now belongs to another container, which can schedule it again) or is
+// replaced. The scheduler follows its container's model for all this.
+
+@interface AVTTabLoadingScheduler : NSObject<AVTFrameClockClient>
+
+- (id) initWithContainer: (AVTContainer*) container;
+
+// Queues the loading of |document|, which must be in the container. A document has one load at a time; scheduling another one
+// cancels the first. |completion| may be nil.
+
+- (void) scheduleLoadingOfTabDocument: (AVTTabDocument*) document
+                                 work: (AVTTabLoadingWork) work
+                           completion: (AVTTabLoadingCompletion) completion;
+
+- (void) cancelLoadingOfTabDocument: (AVTTabDocument*) document;
+- (void) cancelAllLoading;
+
+// Returns YES if |document| has a load waiting or running.
+
+- (BOOL) isLoadingScheduledForTabDocument: (AVTTabDocument*) document;
+
+// Called by the container as it goes away. Cancels everything, settling the loading state right away, and stops following the
+// model. Work that is already running finishes on its own but reports nothing.
+
+- (void) invalidate;
+
+@property (nonatomic, assign) AVTContainer* container;              // Weak
+
+@property (nonatomic, assign) NSUInteger maxConcurrentLoads;        // Loads running at once. Defaults to 4.
+@property (nonatomic, assign) NSUInteger neighbourCount;            // Tabs on either side of the selected one that count as its
+                                                                    // neighbours. Defaults to 2.
+// Instrumentation.
+
+@property (nonatomic, readonly) NSUInteger waitingCount;
+@property (nonatomic, readonly) NSUInteger runningCount;
+@property (nonatomic, readonly) NSUInteger finishedCount;           // Loads whose work ran to the end.
+@property (nonatomic, readonly) NSUInteger cancelledCount;
+@property (nonatomic, readonly) NSUInteger stateUpdateCount;        // Batches of loading state changes applied.
+
+@end
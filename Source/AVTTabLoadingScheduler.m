@@ -0,0 +1,432 @@
+//
+//  AVTTabbedWindows - AVTTabLoadingScheduler.m
+//
+//  Copyright (c) 2013 Avatron Software, Inc. All rights reserved.
+//
+
+#import "AVTTabLoadingScheduler.h"
+
+#import "AVTContainer.h"
+#import "AVTContainerRegistry.h"
+#import "AVTTabDocument.h"
+#import "AVTTabWellModel.h"
+
+static const NSUInteger kDefaultMaxConcurrentLoads = 4;
+static const NSUInteger kDefaultNeighbourCount = 2;
+
+typedef enum
+{
+    eTabLoadWaiting,
+    eTabLoadRunning,
+    eTabLoadOver
+
+} AVTTabLoadState;
+
+// One scheduled load. Once a load is cancelled or over it is never reused; scheduling the document again makes a new one.
+
+@interface AVTTabLoad : NSObject
+
+@property (nonatomic, retain) AVTTabDocument* document;
+@property (nonatomic, copy) AVTTabLoadingWork work;
+@property (nonatomic, copy) AVTTabLoadingCompletion completion;
+@property (nonatomic, assign) AVTTabLoadState state;
+@property (atomic, assign) BOOL cancelled;                  // Read by the work on its background queue.
+@property (nonatomic, assign) BOOL finished;
+@property (nonatomic, assign) BOOL stateChangePending;
+@property (nonatomic, assign) NSUInteger rank;              // Lower starts first, see |-sortWaitingLoads|.
+@property (nonatomic, assign) NSUInteger index;             // Model index when last ranked.
+
+@end
+
+@interface AVTTabLoadingScheduler()
+
+- (void) startLoadsIfPossible;
+- (void) sortWaitingLoads;
+- (void) invalidatePriorities;
+- (void) loadDidEnd: (AVTTabLoad*) load;
+- (void) noteStateChangeOfLoad: (AVTTabLoad*) load;
+- (void) applyStateChanges;
+
+- (void) tabSelected: (NSNotification*) notification;
+- (void) tabDetached: (NSNotification*) notification;
+- (void) tabReplaced: (NSNotification*) notification;
+- (void) tabsChanged: (NSNotification*) notification;
+- (void) tabDocumentDidClose: (NSNotification*) notification;
+
+@property (nonatomic, retain) NSMapTable* loads;                // Document -> its current AVTTabLoad.
+@property (nonatomic, retain) NSMutableArray* waitingLoads;     // In start order while |prioritiesValid|.
+@property (nonatomic, retain) NSMutableArray* runningLoads;
+@property (nonatomic, retain) NSMutableArray* stateChanges;     // Loads whose state changed since the last batch.
+@property (nonatomic, retain) NSMapTable* selectionSerials;     // Document -> NSNumber, higher for a more recent selection.
+@property (nonatomic, assign) NSUInteger selectionSerial;
+@property (nonatomic, assign) BOOL prioritiesValid;
+
+@property (nonatomic, assign) NSUInteger finishedCount;
+@property (nonatomic, assign) NSUInteger cancelledCount;
+@property (nonatomic, assign) NSUInteger stateUpdateCount;
+
+@end
+
+@implementation AVTTabLoadingScheduler
+
+- (id) initWithContainer: (AVTContainer*) container
+{
+    self = [super init];
+    if( self != nil )
+    {
+        NSPointerFunctionsOptions weakOptions = NSPointerFunctionsOpaqueMemory | NSPointerFunctionsObjectPointerPersonality;
+        NSPointerFunctionsOptions strongOptions = NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPersonality;
+
+        _container = container;
+        _maxConcurrentLoads = kDefaultMaxConcurrentLoads;
+        _neighbourCount = kDefaultNeighbourCount;
+
+        _loads = [[NSMapTable alloc] initWithKeyOptions: weakOptions valueOptions: strongOptions capacity: 0];
+        _waitingLoads = [[NSMutableArray alloc] init];
+        _runningLoads = [[NSMutableArray alloc] init];
+        _stateChanges = [[NSMutableArray alloc] init];
+        _selectionSerials = [[NSMapTable alloc] initWithKeyOptions: weakOptions valueOptions: strongOptions capacity: 0];
+
+        AVTTabWellModel* model = container.tabWellModel;
+        NSNotificationCenter* center = [NSNotificationCenter defaultCenter];
+        [center addObserver: self selector: @selector( tabSelected: ) name: kDidSelectTabDocumentNotification object: model];
+        [center addObserver: self selector: @selector( tabDetached: ) name: kDidDetachTabDocumentNotification object: model];
+        [center addObserver: self selector: @selector( tabReplaced: ) name: kTabDocumentDidGetReplacedNotification object: model];
+        [center addObserver: self selector: @selector( tabsChanged: ) name: kDidInsertTabDocumentNotification object: model];
+        [center addObserver: self selector: @selector( tabsChanged: ) name: kDidInsertTabDocumentsNotification object: model];
+        [center addObserver: self selector: @selector( tabsChanged: ) name: kTabDocumentDidMoveNotification object: model];
+        [center addObserver: self selector: @selector( tabDocumentDidClose: ) name: AVTTabDocumentDidCloseNotification object: nil];
+    }
+
+    return self;
+}
+
+- (void) dealloc
+{
+    [self invalidate];
+
+    [_loads release];
+    [_waitingLoads release];
+    [_runningLoads release];
+    [_stateChanges release];
+    [_selectionSerials release];
+
+    [super dealloc];
+}
+
+- (NSUInteger) waitingCount
+{
+    return self.waitingLoads.count;
+}
+
+- (NSUInteger) runningCount
+{
+    return self.runningLoads.count;
+}
+
+- (void) setMaxConcurrentLoads: (NSUInteger) maxConcurrentLoads
+{
+    _maxConcurrentLoads = MAX( maxConcurrentLoads, 1 );
+    [self startLoadsIfPossible];
+}
+
+- (void) setNeighbourCount: (NSUInteger) neighbourCount
+{
+    _neighbourCount = neighbourCount;
+    [self invalidatePriorities];
+}
+
+- (void) scheduleLoadingOfTabDocument: (AVTTabDocument*) document
+                                 work: (AVTTabLoadingWork) work
+                           completion: (AVTTabLoadingCompletion) completion
+{
+    NSAssert( [NSThread isMainThread], @"Must be done on main thread." );
+    NSAssert( document && work, @"Nothing to load." );
+
+    [self cancelLoadingOfTabDocument: document];
+
+    AVTTabLoad* load = [[AVTTabLoad alloc] init];
+    load.document = document;
+    load.work = work;
+    load.completion = completion;
+    load.state = eTabLoadWaiting;
+
+    [self.loads setObject: load forKey: document];
+    [self.waitingLoads addObject: load];
+    [self noteStateChangeOfLoad: load];
+    [load release];
+
+    self.prioritiesValid = NO;
+    [self startLoadsIfPossible];
+}
+
+- (void) cancelLoadingOfTabDocument: (AVTTabDocument*) document
+{
+    AVTTabLoad* load = [self.loads objectForKey: document];
+    if( load == nil )
+        return;
+
+    [load retain];
+    [self.loads removeObjectForKey: document];
+
+    load.cancelled = YES;
+    self.cancelledCount++;
+
+    // A running load is over once its work notices and returns.
+
+    if( load.state == eTabLoadWaiting )
+    {
+        [self.waitingLoads removeObjectIdenticalTo: load];
+        load.state = eTabLoadOver;
+        [self noteStateChangeOfLoad: load];
+    }
+
+    [load release];
+}
+
+- (void) cancelAllLoading
+{
+    for( AVTTabDocument* document in [[self.loads keyEnumerator] allObjects] )
+        [self cancelLoadingOfTabDocument: document];
+}
+
+- (BOOL) isLoadingScheduledForTabDocument: (AVTTabDocument*) document
+{
+    return [self.loads objectForKey: document] != nil;
+}
+
+- (void) invalidate
+{
+    [[NSNotificationCenter defaultCenter] removeObserver: self];
+    [self cancelAllLoading];
+
+    // Loads still running won't report once the container is gone, so settle them now.
+
+    for( AVTTabLoad* load in self.runningLoads )
+    {
+        load.state = eTabLoadOver;
+        [self noteStateChangeOfLoad: load];
+    }
+
+    self.container = nil;
+    [self applyStateChanges];
+    [[AVTFrameClock sharedClock] deactivateClient: self];
+}
+
+#pragma mark - AVTFrameClockClient
+
+- (BOOL) frameClock: (AVTFrameClock*) clock tickAtTime: (NSTimeInterval) time
+{
+    [self applyStateChanges];
+
+    return NO;
+}
+
+#pragma mark - Implementation
+
+- (void) startLoadsIfPossible
+{
+    if( self.container == nil )
+        return;
+
+    if( !self.prioritiesValid )
+        [self sortWaitingLoads];
+
+    while( self.runningLoads.count < self.maxConcurrentLoads && self.waitingLoads.count )
+    {
+        AVTTabLoad* load = self.waitingLoads[0];
+        [self.runningLoads addObject: load];
+        [self.waitingLoads removeObjectAtIndex: 0];
+
+        load.state = eTabLoadRunning;
+        [self noteStateChangeOfLoad: load];
+
+        // The selected tab is the one someone is looking at.
+
+        long queuePriority = load.rank == 0 ? DISPATCH_QUEUE_PRIORITY_HIGH : DISPATCH_QUEUE_PRIORITY_DEFAULT;
+        dispatch_async( dispatch_get_global_queue( queuePriority, 0 ), ^{
+            if( !load.cancelled )
+            {
+                load.work( load.document, ^BOOL {
+                    return load.cancelled;
+                } );
+            }
+
+            dispatch_async( dispatch_get_main_queue(), ^{
+                [self loadDidEnd: load];
+            } );
+        } );
+    }
+}
+
+// Puts the waiting loads in start order: the selected tab, then its neighbours by distance, then tabs by how recently they were
+// selected, then tabs never selected in tab order, then anything no longer in the container.
+
+- (void) sortWaitingLoads
+{
+    AVTContainerRegistry* registry = [AVTContainerRegistry sharedRegistry];
+    NSInteger selectedIndex = self.container.tabWellModel.selectedIndex;
+    NSUInteger neighbourCount = self.neighbourCount;
+
+    for( AVTTabLoad* load in self.waitingLoads )
+    {
+        NSInteger index = [registry indexOfTabDocument: load.document container: NULL];
+        NSUInteger distance = (index != kNoTab && selectedIndex != kNoTab) ? labs( index - selectedIndex ) : NSUIntegerMax;
+        NSUInteger serial = [[self.selectionSerials objectForKey: load.document] unsignedIntegerValue];
+
+        load.index = index != kNoTab ? index : NSUIntegerMax;
+        if( distance <= neighbourCount )
+            load.rank = distance;
+        else if( serial )
+            load.rank = neighbourCount + 1 + (self.selectionSerial - serial);
+        else
+            load.rank = index != kNoTab ? NSUIntegerMax - 1 : NSUIntegerMax;
+    }
+
+    [self.waitingLoads sortUsingComparator: ^( AVTTabLoad* a, AVTTabLoad* b ) {
+        if( a.rank != b.rank )
+            return a.rank < b.rank ? NSOrderedAscending : NSOrderedDescending;
+        if( a.index != b.index )
+            return a.index < b.index ? NSOrderedAscending : NSOrderedDescending;
+        return NSOrderedSame;
+    }];
+
+    self.prioritiesValid = YES;
+}
+
+- (void) invalidatePriorities
+{
+    self.prioritiesValid = NO;
+    [self startLoadsIfPossible];
+}
+
+- (void) loadDidEnd: (AVTTabLoad*) load
+{
+    [[load retain] autorelease];
+    [self.runningLoads removeObjectIdenticalTo: load];
+
+    if( self.container == nil )
+        return;
+
+    if( !load.cancelled )
+    {
+        load.finished = YES;
+        self.finishedCount++;
+        [self.loads removeObjectForKey: load.document];
+    }
+
+    load.state = eTabLoadOver;
+    [self noteStateChangeOfLoad: load];
+
+    [self startLoadsIfPossible];
+}
+
+// Loading state changes are applied together on the next frame, so a burst of loads starting and ending costs the views one update.
+
+- (void) noteStateChangeOfLoad: (AVTTabLoad*) load
+{
+    if( !load.stateChangePending )
+    {
+        load.stateChangePending = YES;
+        [self.stateChanges addObject: load];
+        [[AVTFrameClock sharedClock] activateClient: self];
+    }
+}
+
+- (void) applyStateChanges
+{
+    if( self.stateChanges.count == 0 )
+        return;
+
+    NSArray* changes = [[self.stateChanges copy] autorelease];
+    [self.stateChanges removeAllObjects];
+
+    // A document's state is that of its current load, if it has one. A load cancelled by rescheduling may end after its
+    // replacement started, and mustn't clear the replacement's state.
+
+    for( AVTTabLoad* load in changes )
+    {
+        load.stateChangePending = NO;
+
+        AVTTabDocument* document = load.document;
+        AVTTabLoad* current = [self.loads objectForKey: document];
+        BOOL waiting = current != nil && current.state == eTabLoadWaiting;
+        BOOL loading = current != nil && current.state == eTabLoadRunning;
+
+        if( document.isWaitingForResponse != waiting )
+            document.isWaitingForResponse = waiting;
+        if( document.isLoading != loading )
+            document.isLoading = loading;
+
+        [self.container loadingStateDidChange: document];
+    }
+
+    for( AVTTabLoad* load in changes )
+    {
+        if( load.state == eTabLoadOver && load.completion )
+        {
+            AVTTabLoadingCompletion completion = [[load.completion retain] autorelease];
+            load.completion = nil;
+            completion( load.document, load.finished );
+        }
+    }
+
+    self.stateUpdateCount++;
+}
+
+#pragma mark - Notifications
+
+- (void) tabSelected: (NSNotification*) notification
+{
+    AVTTabDocument* document = notification.userInfo[kNewTabDocumentKey];
+    if( document )
+    {
+        self.selectionSerial++;
+        [self.selectionSerials setObject: @(self.selectionSerial) forKey: document];
+    }
+
+    [self invalidatePriorities];
+}
+
+- (void) tabDetached: (NSNotification*) notification
+{
+    AVTTabDocument* document = notification.userInfo[kTabDocumentKey];
+    [self cancelLoadingOfTabDocument: document];
+    [self.selectionSerials removeObjectForKey: document];
+    [self invalidatePriorities];
+}
+
+- (void) tabReplaced: (NSNotification*) notification
+{
+    AVTTabDocument* document = notification.userInfo[kOldTabDocumentKey];
+    [self cancelLoadingOfTabDocument: document];
+    [self.selectionSerials removeObjectForKey: document];
+    [self invalidatePriorities];
+}
+
+- (void) tabsChanged: (NSNotification*) notification
+{
+    [self invalidatePriorities];
+}
+
+// Closing starts before the tab is detached, and may wait on unload listeners; there's no point loading meanwhile.
+
+- (void) tabDocumentDidClose: (NSNotification*) notification
+{
+    [self cancelLoadingOfTabDocument: notification.object];
+}
+
+@end
+
+@implementation AVTTabLoad
+
+- (void) dealloc
+{
+    [_document release];
+    [_work release];
+    [_completion release];
+
+    [super dealloc];
+}
+
+@end
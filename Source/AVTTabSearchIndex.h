@@ -0,0 +1,60 @@
+//
+//  AVTTabbedWindows - AVTTabSearchIndex.h
+//
+//  Copyright (c) 2013 Avatron Software, Inc. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@class AVTTabDocument;
+
+// A title search index for jumping to a tab by name in sessions with many thousands of tabs. Titles are folded (case and
+// diacritics ignored, punctuation treated as a word break) and broken into three character grams, and each gram keeps a posting
+// list of the entries containing it. A query looks up the posting lists of its own grams, so its cost depends on how common the
+// query's grams are rather than on the number of tabs.
+//
+// Matching is fuzzy: an entry matches if it contains at least half of the query's grams. Results are ranked by how many grams
+// they share with the query, then by whether the title contains the query outright, at the start of a word or anywhere, then by
+// title length. One and two letter queries match words that start with them.
+//
+// The index is kept up to date incrementally. Entries are any object with a title; tab documents can be tracked, in which case
+// their title is observed. The shared index tracks every tab document in every container, following the tab well models as tabs
+// are inserted, detached and replaced.
+//
+// Memory is accounted and capped at |byteLimit|. Only the first part of very long titles is indexed, and once the index is full
+// further entries are turned away (and counted in |rejectedCount|) until others are removed.
+
+@interface AVTTabSearchIndex : NSObject
+
+// The index of every tab document in the application.
+
++ (AVTTabSearchIndex*) sharedIndex;
+
+- (id) initWithByteLimit: (NSUInteger) byteLimit;
+
+// Adds |object| under |title|, or updates its title. Objects are not retained and must be removed before they go away. Returns NO
+// if the index was too full to take the entry.
+
+- (BOOL) setTitle: (NSString*) title forObject: (id) object;
+- (void) removeObject: (id) object;
+- (void) removeAllObjects;
+
+// Indexes |document| and keeps its entry up to date as its title changes, until it is untracked.
+
+- (void) trackTabDocument: (AVTTabDocument*) document;
+- (void) untrackTabDocument: (AVTTabDocument*) document;
+
+// Returns up to |limit| objects matching |query|, best match first.
+
+- (NSArray*) objectsMatchingQuery: (NSString*) query limit: (NSUInteger) limit;
+
+@property (nonatomic, readonly) NSUInteger byteLimit;
+
+// Instrumentation.
+
+@property (nonatomic, readonly) NSUInteger count;           // Number of entries.
+@property (nonatomic, readonly) NSUInteger gramCount;       // Number of distinct grams seen.
+@property (nonatomic, readonly) NSUInteger byteCount;       // Approximate memory used by the index.
+@property (nonatomic, readonly) NSUInteger rejectedCount;   // Entries turned away because the index was full.
+
+@end
@@ -0,0 +1,640 @@
+//
+//  AVTTabbedWindows - AVTTabSearchIndex.m
+//
+//  Copyright (c) 2013 Avatron Software, Inc. All rights reserved.
+//
+
+#import "AVTTabSearchIndex.h"
+
+#import "AVTContainer.h"
+#import "AVTContainerRegistry.h"
+#import "AVTTabDocument.h"
+#import "AVTTabWellModel.h"
+
+static const NSUInteger kDefaultByteLimit = 32 * 1024 * 1024;
+
+// Only this many characters of each title are indexed. Tab titles that long are URLs and the like, whose tail is rarely what
+// someone types.
+
+enum { kMaxIndexedLength = 128 };
+
+// A folded title is at most a leading space, the indexed characters and a trailing space, and has at most two grams per character.
+
+enum { kMaxFoldedLength = kMaxIndexedLength + 2 };
+enum { kMaxGramCount = 2 * kMaxFoldedLength };
+
+static const NSUInteger kInitialGramCapacity = 1024;       // Must be a power of two.
+static const NSUInteger kInitialEntryCapacity = 256;
+static const uint32_t kNoEntry = UINT32_MAX;
+
+// Rough per-entry cost of the object to entry map, for the memory accounting.
+
+static const NSUInteger kObjectMapEntryBytes = 32;
+
+static void* kTitleObservingContext = &kTitleObservingContext;
+
+static NSCharacterSet* sAlphanumerics = nil;
+
+// The entries containing one gram, in no particular order.
+
+typedef struct
+{
+    uint32_t* entries;
+    uint32_t count;
+    uint32_t capacity;
+
+} AVTPostingList;
+
+// A slot of the open addressed gram table.
+
+typedef struct
+{
+    uint64_t gram;                  // 0 for an unused slot.
+    AVTPostingList list;
+
+} AVTGramSlot;
+
+typedef struct
+{
+    id object;                      // Not retained. nil for a free entry.
+    unichar* title;                 // Folded title, malloc'ed.
+    uint32_t length;
+    uint32_t nextFree;              // Next free entry, if this one is free.
+
+} AVTSearchEntry;
+
+typedef struct
+{
+    uint32_t entry;
+    uint32_t score;
+    uint32_t length;
+
+} AVTSearchMatch;
+
+static NSUInteger AVTFoldTitle( NSString* title, unichar* folded, BOOL trailingSpace );
+static NSUInteger AVTTitleGrams( const unichar* title, NSUInteger length, uint64_t* grams );
+static NSUInteger AVTFindCharacters( const unichar* haystack, NSUInteger length, const unichar* needle, NSUInteger needleLength );
+static int AVTCompareGrams( const void* a, const void* b );
+static int AVTCompareMatches( const void* a, const void* b );
+
+@interface AVTTabSearchIndex()
+{
+    AVTGramSlot* _grams;
+    NSUInteger _gramCapacity;
+    NSUInteger _gramCount;
+
+    AVTSearchEntry* _entries;
+    uint16_t* _hits;                // Query scratch, per entry.
+    uint32_t* _touched;             // Query scratch, the entries with hits.
+    NSUInteger _entryCapacity;
+    NSUInteger _entryHighWater;     // Entries past this have never been used.
+    uint32_t _firstFree;
+
+    CFMutableDictionaryRef _objectEntries;  // Object -> entry index + 1.
+
+    NSUInteger _postingBytes;
+    NSUInteger _titleBytes;
+}
+
+- (void) followTabWellModels;
+- (void) tabInserted: (NSNotification*) notification;
+- (void) tabsInserted: (NSNotification*) notification;
+- (void) tabDetached: (NSNotification*) notification;
+- (void) tabReplaced: (NSNotification*) notification;
+
+- (AVTGramSlot*) slotForGram: (uint64_t) gram create: (BOOL) create;
+- (void) growGramTable;
+- (uint32_t) allocateEntry;
+- (void) addEntry: (uint32_t) entry toGrams: (const uint64_t*) grams count: (NSUInteger) count;
+- (void) removeEntry: (uint32_t) entry;
+
+@property (nonatomic, assign) NSUInteger count;
+@property (nonatomic, assign) NSUInteger rejectedCount;
+@property (nonatomic, retain) NSHashTable* trackedDocuments;   // Not retained.
+
+@end
+
+@implementation AVTTabSearchIndex
+
++ (void) initialize
+{
+    if( self == [AVTTabSearchIndex class] )
+        sAlphanumerics = [[NSCharacterSet alphanumericCharacterSet] retain];
+}
+
++ (AVTTabSearchIndex*) sharedIndex
+{
+    static AVTTabSearchIndex* sSharedIndex = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once( &onceToken, ^{
+        sSharedIndex = [[AVTTabSearchIndex alloc] initWithByteLimit: kDefaultByteLimit];
+        [sSharedIndex followTabWellModels];
+    } );
+
+    return sSharedIndex;
+}
+
+- (id) init
+{
+    return [self initWithByteLimit: kDefaultByteLimit];
+}
+
+- (id) initWithByteLimit: (NSUInteger) byteLimit
+{
+    self = [super init];
+    if( self != nil )
+    {
+        _byteLimit = byteLimit;
+
+        _gramCapacity = kInitialGramCapacity;
+        _grams = calloc( _gramCapacity, sizeof( AVTGramSlot ) );
+
+        _entryCapacity = kInitialEntryCapacity;
+        _entries = calloc( _entryCapacity, sizeof( AVTSearchEntry ) );
+        _hits = calloc( _entryCapacity, sizeof( uint16_t ) );
+        _touched = calloc( _entryCapacity, sizeof( uint32_t ) );
+        _firstFree = kNoEntry;
+
+        _objectEntries = CFDictionaryCreateMutable( NULL, 0, NULL, NULL );
+        _trackedDocuments = [[NSHashTable alloc] initWithOptions: NSPointerFunctionsOpaqueMemory | NSPointerFunctionsObjectPointerPersonality capacity: 0];
+    }
+
+    return self;
+}
+
+- (void) dealloc
+{
+    [[NSNotificationCenter defaultCenter] removeObserver: self];
+    [self removeAllObjects];
+
+    free( _grams );
+    free( _entries );
+    free( _hits );
+    free( _touched );
+    CFRelease( _objectEntries );
+    [_trackedDocuments release];
+
+    [super dealloc];
+}
+
+- (NSUInteger) gramCount
+{
+    return _gramCount;
+}
+
+- (NSUInteger) byteCount
+{
+    return _gramCapacity * sizeof( AVTGramSlot ) +
+           _entryCapacity * (sizeof( AVTSearchEntry ) + sizeof( uint16_t ) + sizeof( uint32_t )) +
+           _postingBytes + _titleBytes + self.count * kObjectMapEntryBytes;
+}
+
+- (BOOL) setTitle: (NSString*) title
+        forObject: (id) object
+{
+    unichar folded[kMaxFoldedLength];
+    NSUInteger length = AVTFoldTitle( title, folded, YES );
+
+    uintptr_t existing = (uintptr_t)CFDictionaryGetValue( _objectEntries, object );
+    if( existing )
+    {
+        // Nothing to do if the title folds to the same thing.
+
+        AVTSearchEntry* entry = &_entries[existing - 1];
+        if( entry->length == length && memcmp( entry->title, folded, length * sizeof( unichar ) ) == 0 )
+            return YES;
+
+        [self removeEntry: (uint32_t)(existing - 1)];
+        CFDictionaryRemoveValue( _objectEntries, object );
+        self.count--;
+    }
+
+    uint64_t grams[kMaxGramCount];
+    NSUInteger gramCount = AVTTitleGrams( folded, length, grams );
+
+    // Turn the entry away if it could take the index over its limit. Posting lists grow by doubling, so allow for that.
+
+    NSUInteger cost = length * sizeof( unichar ) + gramCount * 2 * sizeof( uint32_t ) + kObjectMapEntryBytes;
+    if( self.byteCount + cost > self.byteLimit )
+    {
+        self.rejectedCount++;
+        return NO;
+    }
+
+    uint32_t index = [self allocateEntry];
+    AVTSearchEntry* entry = &_entries[index];
+    entry->object = object;
+    entry->length = (uint32_t)length;
+    entry->title = malloc( MAX( length, 1 ) * sizeof( unichar ) );
+    memcpy( entry->title, folded, length * sizeof( unichar ) );
+    _titleBytes += length * sizeof( unichar );
+
+    [self addEntry: index toGrams: grams count: gramCount];
+
+    CFDictionarySetValue( _objectEntries, object, (const void*)(uintptr_t)(index + 1) );
+    self.count++;
+
+    return YES;
+}
+
+- (void) removeObject: (id) object
+{
+    if( [self.trackedDocuments containsObject: object] )
+    {
+        [object removeObserver: self forKeyPath: @"title" context: kTitleObservingContext];
+        [self.trackedDocuments removeObject: object];
+    }
+
+    uintptr_t existing = (uintptr_t)CFDictionaryGetValue( _objectEntries, object );
+    if( existing )
+    {
+        [self removeEntry: (uint32_t)(existing - 1)];
+        CFDictionaryRemoveValue( _objectEntries, object );
+        self.count--;
+    }
+}
+
+- (void) removeAllObjects
+{
+    for( AVTTabDocument* document in [self.trackedDocuments allObjects] )
+        [document removeObserver: self forKeyPath: @"title" context: kTitleObservingContext];
+    [self.trackedDocuments removeAllObjects];
+
+    for( NSUInteger i = 0; i < _gramCapacity; i++ )
+        free( _grams[i].list.entries );
+    memset( _grams, 0, _gramCapacity * sizeof( AVTGramSlot ) );
+    _gramCount = 0;
+
+    for( NSUInteger i = 0; i < _entryHighWater; i++ )
+        free( _entries[i].title );
+    memset( _entries, 0, _entryCapacity * sizeof( AVTSearchEntry ) );
+    _entryHighWater = 0;
+    _firstFree = kNoEntry;
+
+    CFDictionaryRemoveAllValues( _objectEntries );
+    _postingBytes = 0;
+    _titleBytes = 0;
+    self.count = 0;
+}
+
+- (void) trackTabDocument: (AVTTabDocument*) document
+{
+    if( ![self.trackedDocuments containsObject: document] )
+    {
+        [self.trackedDocuments addObject: document];
+        [document addObserver: self forKeyPath: @"title" options: 0 context: kTitleObservingContext];
+    }
+
+    [self setTitle: document.title forObject: document];
+}
+
+- (void) untrackTabDocument: (AVTTabDocument*) document
+{
+    [self removeObject: document];
+}
+
+- (void) observeValueForKeyPath: (NSString*) keyPath
+                       ofObject: (id) object
+                         change: (NSDictionary*) change
+                        context: (void*) context
+{
+    if( context == kTitleObservingContext )
+        [self setTitle: [object title] forObject: object];
+    else
+        [super observeValueForKeyPath: keyPath ofObject: object change: change context: context];
+}
+
+- (NSArray*) objectsMatchingQuery: (NSString*) query
+                            limit: (NSUInteger) limit
+{
+    unichar folded[kMaxFoldedLength];
+    NSUInteger length = AVTFoldTitle( query, folded, NO );
+    if( length < 2 || limit == 0 )
+        return @[];
+
+    uint64_t grams[kMaxGramCount];
+    NSUInteger gramCount = AVTTitleGrams( folded, length, grams );
+
+    // Count the query's grams in every entry that has any of them.
+
+    NSUInteger touchedCount = 0;
+    for( NSUInteger g = 0; g < gramCount; g++ )
+    {
+        AVTGramSlot* slot = [self slotForGram: grams[g] create: NO];
+        if( slot == NULL )
+            continue;
+
+        for( uint32_t i = 0; i < slot->list.count; i++ )
+        {
+            uint32_t entry = slot->list.entries[i];
+            if( _hits[entry]++ == 0 )
+                _touched[touchedCount++] = entry;
+        }
+    }
+
+    // Score the entries with enough grams: shared grams first, then an outright match of the query at the start of a word (the
+    // folded query starts with a space) or anywhere in the title.
+
+    NSUInteger minHits = (gramCount + 1) / 2;
+    AVTSearchMatch* matches = malloc( MAX( touchedCount, 1 ) * sizeof( AVTSearchMatch ) );
+    NSUInteger matchCount = 0;
+    for( NSUInteger i = 0; i < touchedCount; i++ )
+    {
+        uint32_t entry = _touched[i];
+        uint16_t hits = _hits[entry];
+        _hits[entry] = 0;
+        if( hits < minHits )
+            continue;
+
+        AVTSearchEntry* searchEntry = &_entries[entry];
+        uint32_t score = hits * 4;
+        if( AVTFindCharacters( searchEntry->title, searchEntry->length, folded, length ) != NSNotFound )
+            score += 3;
+        else if( AVTFindCharacters( searchEntry->title, searchEntry->length, folded + 1, length - 1 ) != NSNotFound )
+            score += 2;
+
+        matches[matchCount].entry = entry;
+        matches[matchCount].score = score;
+        matches[matchCount].length = searchEntry->length;
+        matchCount++;
+    }
+
+    qsort( matches, matchCount, sizeof( AVTSearchMatch ), AVTCompareMatches );
+
+    NSUInteger resultCount = MIN( matchCount, limit );
+    NSMutableArray* results = [NSMutableArray arrayWithCapacity: resultCount];
+    for( NSUInteger i = 0; i < resultCount; i++ )
+        [results addObject: _entries[matches[i].entry].object];
+
+    free( matches );
+
+    return results;
+}
+
+#pragma mark - Implementation
+
+- (void) followTabWellModels
+{
+    NSNotificationCenter* center = [NSNotificationCenter defaultCenter];
+    [center addObserver: self selector: @selector( tabInserted: ) name: kDidInsertTabDocumentNotification object: nil];
+    [center addObserver: self selector: @selector( tabsInserted: ) name: kDidInsertTabDocumentsNotification object: nil];
+    [center addObserver: self selector: @selector( tabDetached: ) name: kDidDetachTabDocumentNotification object: nil];
+    [center addObserver: self selector: @selector( tabReplaced: ) name: kTabDocumentDidGetReplacedNotification object: nil];
+
+    // Pick up the tabs that are already open.
+
+    for( AVTContainer* container in [AVTContainerRegistry sharedRegistry].containers )
+    {
+        for( AVTTabDocument* document in [container allTabDocuments] )
+            [self trackTabDocument: document];
+    }
+}
+
+- (void) tabInserted: (NSNotification*) notification
+{
+    [self trackTabDocument: notification.userInfo[kTabDocumentKey]];
+}
+
+- (void) tabsInserted: (NSNotification*) notification
+{
+    for( AVTTabDocument* document in notification.userInfo[kTabDocumentsKey] )
+        [self trackTabDocument: document];
+}
+
+- (void) tabDetached: (NSNotification*) notification
+{
+    [self untrackTabDocument: notification.userInfo[kTabDocumentKey]];
+}
+
+- (void) tabReplaced: (NSNotification*) notification
+{
+    [self untrackTabDocument: notification.userInfo[kOldTabDocumentKey]];
+    [self trackTabDocument: notification.userInfo[kNewTabDocumentKey]];
+}
+
+- (AVTGramSlot*) slotForGram: (uint64_t) gram
+                      create: (BOOL) create
+{
+    NSUInteger mask = _gramCapacity - 1;
+    NSUInteger index = (NSUInteger)((gram * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+    while( _grams[index].gram != 0 )
+    {
+        if( _grams[index].gram == gram )
+            return &_grams[index];
+        index = (index + 1) & mask;
+    }
+
+    if( !create )
+        return NULL;
+
+    // Keep the table at most half full.
+
+    if( (_gramCount + 1) * 2 > _gramCapacity )
+    {
+        [self growGramTable];
+        return [self slotForGram: gram create: YES];
+    }
+
+    _grams[index].gram = gram;
+    _gramCount++;
+
+    return &_grams[index];
+}
+
+- (void) growGramTable
+{
+    AVTGramSlot* oldGrams = _grams;
+    NSUInteger oldCapacity = _gramCapacity;
+
+    _gramCapacity *= 2;
+    _grams = calloc( _gramCapacity, sizeof( AVTGramSlot ) );
+    _gramCount = 0;
+
+    for( NSUInteger i = 0; i < oldCapacity; i++ )
+    {
+        if( oldGrams[i].gram != 0 )
+        {
+            AVTGramSlot* slot = [self slotForGram: oldGrams[i].gram create: YES];
+            slot->list = oldGrams[i].list;
+        }
+    }
+
+    free( oldGrams );
+}
+
+- (uint32_t) allocateEntry
+{
+    if( _firstFree != kNoEntry )
+    {
+        uint32_t entry = _firstFree;
+        _firstFree = _entries[entry].nextFree;
+        return entry;
+    }
+
+    if( _entryHighWater == _entryCapacity )
+    {
+        NSUInteger oldCapacity = _entryCapacity;
+        _entryCapacity *= 2;
+        _entries = realloc( _entries, _entryCapacity * sizeof( AVTSearchEntry ) );
+        memset( _entries + oldCapacity, 0, (_entryCapacity - oldCapacity) * sizeof( AVTSearchEntry ) );
+        _hits = realloc( _hits, _entryCapacity * sizeof( uint16_t ) );
+        memset( _hits + oldCapacity, 0, (_entryCapacity - oldCapacity) * sizeof( uint16_t ) );
+        _touched = realloc( _touched, _entryCapacity * sizeof( uint32_t ) );
+    }
+
+    return (uint32_t)_entryHighWater++;
+}
+
+- (void) addEntry: (uint32_t) entry
+          toGrams: (const uint64_t*) grams
+            count: (NSUInteger) count
+{
+    for( NSUInteger g = 0; g < count; g++ )
+    {
+        AVTPostingList* list = &[self slotForGram: grams[g] create: YES]->list;
+        if( list->count == list->capacity )
+        {
+            uint32_t capacity = list->capacity ? list->capacity * 2 : 4;
+            list->entries = realloc( list->entries, capacity * sizeof( uint32_t ) );
+            _postingBytes += (capacity - list->capacity) * sizeof( uint32_t );
+            list->capacity = capacity;
+        }
+
+        list->entries[list->count++] = entry;
+    }
+}
+
+// Takes |entry| out of the posting lists of the grams of its title and frees it. Empty posting lists keep their gram; titles
+// reuse the same grams over and over.
+
+- (void) removeEntry: (uint32_t) entry
+{
+    AVTSearchEntry* searchEntry = &_entries[entry];
+
+    uint64_t grams[kMaxGramCount];
+    NSUInteger gramCount = AVTTitleGrams( searchEntry->title, searchEntry->length, grams );
+    for( NSUInteger g = 0; g < gramCount; g++ )
+    {
+        AVTGramSlot* slot = [self slotForGram: grams[g] create: NO];
+        if( slot == NULL )
+            continue;
+
+        AVTPostingList* list = &slot->list;
+        for( uint32_t i = 0; i < list->count; i++ )
+        {
+            if( list->entries[i] == entry )
+            {
+                list->entries[i] = list->entries[--list->count];
+                break;
+            }
+        }
+    }
+
+    _titleBytes -= searchEntry->length * sizeof( unichar );
+    free( searchEntry->title );
+
+    searchEntry->object = nil;
+    searchEntry->title = NULL;
+    searchEntry->length = 0;
+    searchEntry->nextFree = _firstFree;
+    _firstFree = entry;
+}
+
+@end
+
+// Folds |title| into |folded|: case and diacritics are dropped, and anything that isn't a letter or a digit becomes a single space.
+// The result starts with a space, so the first word starts like any other, and ends with one if |trailingSpace| is YES. Queries
+// leave the trailing space off so the last word can be partial. Returns the length of the result.
+
+NSUInteger AVTFoldTitle( NSString* title, unichar* folded, BOOL trailingSpace )
+{
+    NSString* foldedTitle = [title stringByFoldingWithOptions: NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch locale: nil];
+    NSUInteger sourceLength = MIN( foldedTitle.length, (NSUInteger)kMaxIndexedLength );
+    unichar source[kMaxIndexedLength];
+    [foldedTitle getCharacters: source range: NSMakeRange( 0, sourceLength )];
+
+    NSUInteger length = 0;
+    folded[length++] = ' ';
+    for( NSUInteger i = 0; i < sourceLength; i++ )
+    {
+        unichar c = source[i];
+        if( [sAlphanumerics characterIsMember: c] )
+            folded[length++] = c;
+        else if( folded[length - 1] != ' ' )
+            folded[length++] = ' ';
+    }
+
+    if( trailingSpace && folded[length - 1] != ' ' )
+        folded[length++] = ' ';
+    else if( !trailingSpace && length > 1 && folded[length - 1] == ' ' )
+        length--;
+
+    return length;
+}
+
+// Fills |grams| with the distinct grams of the folded |title| and returns how many there are: every run of three characters, and
+// the first letter of every word on its own, so one letter queries work too.
+
+NSUInteger AVTTitleGrams( const unichar* title, NSUInteger length, uint64_t* grams )
+{
+    NSUInteger count = 0;
+    for( NSUInteger i = 0; i + 1 < length; i++ )
+    {
+        if( title[i] == ' ' && title[i + 1] != ' ' )
+            grams[count++] = ((uint64_t)' ' << 16) | title[i + 1];
+
+        if( i + 2 < length )
+            grams[count++] = ((uint64_t)title[i] << 32) | ((uint64_t)title[i + 1] << 16) | title[i + 2];
+    }
+
+    if( count > 1 )
+    {
+        qsort( grams, count, sizeof( uint64_t ), AVTCompareGrams );
+
+        NSUInteger unique = 1;
+        for( NSUInteger i = 1; i < count; i++ )
+        {
+            if( grams[i] != grams[unique - 1] )
+                grams[unique++] = grams[i];
+        }
+
+        count = unique;
+    }
+
+    return count;
+}
+
+NSUInteger AVTFindCharacters( const unichar* haystack, NSUInteger length, const unichar* needle, NSUInteger needleLength )
+{
+    if( needleLength == 0 || needleLength > length )
+        return NSNotFound;
+
+    for( NSUInteger i = 0; i + needleLength <= length; i++ )
+    {
+        if( haystack[i] == needle[0] && memcmp( haystack + i, needle, needleLength * sizeof( unichar ) ) == 0 )
+            return i;
+    }
+
+    return NSNotFound;
+}
+
+int AVTCompareGrams( const void* a, const void* b )
+{
+    uint64_t gramA = *(const uint64_t*)a;
+    uint64_t gramB = *(const uint64_t*)b;
+    return gramA < gramB ? -1 : gramA > gramB ? 1 : 0;
+}
+
+// Best score first, then shorter titles, then older entries.
+
+int AVTCompareMatches( const void* a, const void* b )
+{
+    const AVTSearchMatch* matchA = a;
+    const AVTSearchMatch* matchB = b;
+
+    if( matchA->score != matchB->score )
+        return matchA->score > matchB->score ? -1 : 1;
+    if( matchA->length != matchB->length )
+        return matchA->length < matchB->length ? -1 : 1;
+    return matchA->entry < matchB->entry ? -1 : matchA->entry > matchB->entry ? 1 : 0;
+}
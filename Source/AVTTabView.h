@@ -28,6 +28,27 @@ typedef enum
 
 @interface AVTTabView : AVTGradientView
 
+// Tabs are drawn from pre-rendered background and border bitmaps shared by every tab of the same size and state. Turning this
+// off draws every tab from scratch, for comparison.
+
++ (BOOL) drawsFromCache;
++ (void) setDrawsFromCache: (BOOL) drawsFromCache;
+
+// Draws the tab's background, glows and border into the current context in the tab's own coordinates. Called by |-drawRect:|,
+// or by the tab well when it draws the whole strip in one pass.
+
+- (void) drawTab;
+
+// YES when the tab well draws this tab, leaving |-drawRect:| with nothing to do. The tab view is then only there for events,
+// accessibility and its subviews.
+
+@property (nonatomic, readonly, getter=isDrawnByTabWell) BOOL drawnByTabWell;
+
+// YES if the tab's shape covers any of |rect|, in the tab's coordinates. Adjacent tabs overlap, but mostly where their sides
+// slant away from each other, so this is much tighter than the frame. The sides are taken as straight lines.
+
+- (BOOL) shapeIntersectsRect: (NSRect) rect;
+
 // Begin showing an "alert" glow (shown to call attention to an unselected pinned tab whose title changed).
 
 - (void) startAlert;
@@ -36,7 +57,10 @@ typedef enum
 
 - (void) cancelAlert;
 
-- (void) setTrackingEnabled: (BOOL) enabled;
+// Steps the hover and alert glows to |time| on the glow animator's clock, redrawing if either changed. Returns NO once both have
+// settled. Called by the glow animator.
+
+- (BOOL) advanceGlowToTime: (NSTimeInterval) time;
 
 @property (nonatomic, assign) IBOutlet AVTTabController* tabController;
 @property (nonatomic, retain) IBOutlet AVTHoverCloseButton* closeButton;
@@ -63,6 +87,7 @@ typedef enum
 
 @property (nonatomic, assign) NSTimeInterval tearTime;                  // Time since tear happened
 @property (nonatomic, assign) NSPoint tearOrigin;                       // Origin of the tear rect
+@property (nonatomic, assign) NSPoint tearDestination;                  // Where the tear rect is heading (under the mouse)
 @property (nonatomic, assign) NSPoint dragOrigin;                       // Origin point of the drag
 @property (nonatomic, assign) AVTTabWindowController* sourceController; // weak. controller starting the drag
 @property (nonatomic, assign) NSWindow* sourceWindow;                   // weak. The window starting the drag
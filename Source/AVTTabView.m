@@ -12,7 +12,11 @@
 
 #import "AVTTabView.h"
 
+#import "AVTBitmapCache.h"
+#import "AVTDropTargetRegistry.h"
+#import "AVTFrameClock.h"
 #import "AVTHoverCloseButton.h"
+#import "AVTTabGlow.h"
 #import "AVTTabController.h"
 #import "AVTTabWindowController.h"
 #import "AVTTabWellView.h"
@@ -26,21 +30,6 @@ const CGFloat kInsetMultiplier = 2.0f / 3.0f;
 const CGFloat kControlPoint1Multiplier = 1.0f / 3.0f;
 const CGFloat kControlPoint2Multiplier = 3.0f / 8.0f;
 
-// The amount of time in seconds during which each type of glow increases, holds
-// steady, and decreases, respectively.
-
-const NSTimeInterval kHoverShowDuration = 0.20;
-const NSTimeInterval kHoverHoldDuration = 0.02;
-const NSTimeInterval kHoverHideDuration = 0.40;
-const NSTimeInterval kAlertShowDuration = 0.40;
-const NSTimeInterval kAlertHoldDuration = 0.40;
-const NSTimeInterval kAlertHideDuration = 0.40;
-
-// The default time interval in seconds between glow updates (when
-// increasing/decreasing).
-
-const NSTimeInterval kGlowUpdateInterval = 0.025;
-
 const CGFloat kTearDistance = 36.0f;
 const NSTimeInterval kTearDuration = 0.333;
 
@@ -49,14 +38,62 @@ const NSTimeInterval kTearDuration = 0.333;
 
 const CGFloat kRapidCloseDistance = 2.5f;
 
+// Cached tab backgrounds are rendered at this many steps of overlay opacity between none and the selected tab's.
+
+static const NSInteger kOverlayLevels = 32;
+
+static const NSUInteger kPathCacheCapacity = 64;
+static const NSUInteger kBitmapCacheCapacity = 256;
+
+// The two bitmaps a tab is drawn from. The hover glow goes between them.
+
+typedef enum
+{
+    eTabBitmapBackground,
+    eTabBitmapBorder,
+
+} AVTTabBitmapKind;
+
+static BOOL sDrawsFromCache = YES;
+
+static NSMutableDictionary* sPathCache = nil;
+static AVTBitmapCache* sBitmapCache = nil;
+
+static NSColor* sUnselectedFillColor = nil;
+static NSColor* sBorderColor = nil;
+static NSColor* sActiveBorderColor = nil;
+static NSColor* sHighlightColor = nil;
+static NSGradient* sHoverGlow = nil;
+
+static NSArray* AVTTabBitmapKey( AVTTabBitmapKind kind, NSSize size, CGFloat scale, BOOL selected, BOOL active, NSInteger overlayLevel, CGFloat topInWindow, NSColor* backgroundColor );
+
 #pragma mark - Private
 
-@interface AVTTabView()
+@interface AVTTabView()<AVTFrameClockClient>
 
 - (void) resetLastGlowUpdateTime;
-- (NSTimeInterval) timeElapsedSinceLastGlowUpdate;
 - (void) adjustGlowValue;
 - (NSBezierPath*) bezierPathForRect: (NSRect) rect;
+- (NSBezierPath*) buildBezierPathForRect: (NSRect) rect;
+- (void) drawBackgroundInPath: (NSBezierPath*) path selected: (BOOL) selected overlayAlpha: (CGFloat) overlayAlpha;
+- (void) drawHoverGlowInPath: (NSBezierPath*) path alpha: (CGFloat) alpha;
+- (void) drawBorderInPath: (NSBezierPath*) path selected: (BOOL) selected active: (BOOL) active;
+- (NSPoint) dragWindowOriginAtTime: (NSTimeInterval) time;
+- (void) insertPlaceholderIntoTarget;
+
+// Drop targets for the tab while it's being dragged around after being torn off. Released with the other drag state.
+
+@property (nonatomic, retain) AVTDropTargetRegistry* dropTargets;
+
+// Set when the tab is resized and cleared once it has drawn at the new size. Bitmaps are only cached for a size that has been
+// drawn twice, so tabs whose widths animate don't fill the cache with sizes they pass through once.
+
+@property (nonatomic, assign) BOOL sizeChangedSinceDraw;
+
+// Frame of the placeholder last put into the strip of |targetController|, so it is only moved when the frame changes. Empty while
+// there is none.
+
+@property (nonatomic, assign) NSRect targetPlaceholderFrame;
 
 @end
 
@@ -64,6 +101,22 @@ const CGFloat kRapidCloseDistance = 2.5f;
 
 @implementation AVTTabView
 
++ (void) initialize
+{
+    if( [self class] == [AVTTabView class] )
+    {
+        sPathCache = [[NSMutableDictionary alloc] init];
+        sBitmapCache = [[AVTBitmapCache alloc] initWithCapacity: kBitmapCacheCapacity];
+
+        sUnselectedFillColor = [[NSColor colorWithCalibratedWhite: 1.0 alpha: 0.3] retain];
+        sBorderColor = [[NSColor colorWithDeviceWhite: 0.0 alpha: 0.2] retain];
+        sActiveBorderColor = [[NSColor colorWithDeviceWhite: 0.0 alpha: 0.3] retain];
+        sHighlightColor = [[NSColor colorWithCalibratedWhite: 0xf7 / 255.0 alpha: 1.0] retain];
+        sHoverGlow = [[NSGradient alloc] initWithStartingColor: [NSColor colorWithCalibratedWhite: 1.0 alpha: 1.0]
+                                                   endingColor: [NSColor colorWithCalibratedWhite: 1.0 alpha: 0.0]];
+    }
+}
+
 - (id) initWithFrame: (NSRect) frame
 {
 //    NSLog( @"-[AVTTabView initWithFrame: %@]", NSStringFromRect( frame ) );
@@ -80,8 +133,11 @@ const CGFloat kRapidCloseDistance = 2.5f;
 - (void) dealloc
 {
     [NSObject cancelPreviousPerformRequestsWithTarget: self];
+    [[AVTFrameClock sharedClock] deactivateClient: self];
+    [[AVTTabGlowAnimator sharedAnimator] stopAnimatingTabView: self];
 
     [_closeTrackingArea release];
+    [_dropTargets release];
 
     [super dealloc];
 }
@@ -89,6 +145,18 @@ const CGFloat kRapidCloseDistance = 2.5f;
 - (void) awakeFromNib
 {
     self.showsDivider = NO;
+
+    // The tab well computes hover for the close button from its own tracking area, so the button doesn't need one.
+
+    self.closeButton.externalHoverTracking = YES;
+}
+
+- (void) setFrameSize: (NSSize) newSize
+{
+    if( !NSEqualSizes( newSize, self.frame.size ) )
+        self.sizeChangedSinceDraw = YES;
+
+    [super setFrameSize: newSize];
 }
 
 // Overridden so that mouse clicks come to this view (the parent of the hierarchy) first.
@@ -134,7 +202,7 @@ const CGFloat kRapidCloseDistance = 2.5f;
 - (void) mouseExited: (NSEvent*) theEvent
 {
     self.mouseInside = NO;
-    self.hoverHoldEndTime = [NSDate timeIntervalSinceReferenceDate] + kHoverHoldDuration;
+    self.hoverHoldEndTime = [AVTTabGlowAnimator sharedAnimator].clock.now + kHoverHoldDuration;
     [self resetLastGlowUpdateTime];
     [self adjustGlowValue];
 }
@@ -192,32 +260,7 @@ const CGFloat kRapidCloseDistance = 2.5f;
 
 - (NSArray*) dropTargetsForController: (AVTTabWindowController*) dragController
 {
-    NSMutableArray* targets = [NSMutableArray array];
-    NSWindow* dragWindow = [dragController window];
-    for( NSWindow* window in [NSApp orderedWindows] )
-    {
-        if( window == dragWindow )
-            continue;
-        if( ![window isVisible] )
-            continue;
-
-        // Skip windows on the wrong space.
-
-        if( [window respondsToSelector: @selector( isOnActiveSpace )] )
-        {
-            if( ![window performSelector: @selector( isOnActiveSpace )] )
-                continue;
-        }
-
-        NSWindowController* controller = [window windowController];
-        if( [controller isKindOfClass: [AVTTabWindowController class]] )
-        {
-            AVTTabWindowController* realController = (AVTTabWindowController*)controller;
-            if( [realController canReceiveFrom: dragController] )
-                [targets addObject: controller];
-        }
-    }
-    return targets;
+    return [AVTDropTargetRegistry targetsForDragController: dragController];
 }
 
 // Call to clear out transient weak references we hold during drags.
@@ -230,6 +273,8 @@ const CGFloat kRapidCloseDistance = 2.5f;
     self.sourceController = nil;
     self.sourceWindow = nil;
     self.targetController = nil;
+    self.targetPlaceholderFrame = NSZeroRect;
+    self.dropTargets = nil;
 }
 
 // Sets whether the window background should be visible or invisible when dragging a tab. The background should be invisible when the mouse is over a
@@ -443,26 +488,21 @@ const CGFloat kRapidCloseDistance = 2.5f;
 
     NSPoint thisPoint = [NSEvent mouseLocation];
 
-    // Iterate over possible targets checking for the one the mouse is in. If the tab is just in the frame, bring the window forward to make it
-    // easier to drop something there. If it's in the tab strip, set the new target so that it pops into that window. We can't cache this because we
-    // need the z-order to be correct.
+    // Find the target the mouse is in. If the tab is just in the frame, bring the window forward to make it easier to drop something there.
+    // If it's in the tab strip, set the new target so that it pops into that window. The registry keeps its snapshot of the targets in
+    // z-order for as long as the dragged controller stays the same and no other window moves or is reordered.
 
-    NSArray* targets = [self dropTargetsForController: self.draggedController];
+    if( self.dropTargets == nil || self.dropTargets.dragController != self.draggedController )
+        self.dropTargets = [[[AVTDropTargetRegistry alloc] initWithDragController: self.draggedController] autorelease];
+
+    BOOL inTabWell = NO;
     AVTTabWindowController* newTarget = nil;
-    for( AVTTabWindowController* target in targets )
+    AVTTabWindowController* hitTarget = [self.dropTargets targetAtPoint: thisPoint inTabWell: &inTabWell];
+    if( hitTarget )
     {
-        NSRect windowFrame = target.window.frame;
-        if( NSPointInRect( thisPoint, windowFrame ) )
-        {
-            [[target window] orderFront: self];
-            NSRect tabWellFrame = target.tabWellView.frame;
-            tabWellFrame.origin = [target.window convertBaseToScreen: tabWellFrame.origin];
-            if( NSPointInRect( thisPoint, tabWellFrame ) )
-            {
-                newTarget = target;
-            }
-            break;
-        }
+        [self.dropTargets orderTargetFront: hitTarget];
+        if( inTabWell )
+            newTarget = hitTarget;
     }
 
     // If we're now targeting a new window, re-layout the tabs in the old target and reset how long we've been hovering over this new one.
@@ -471,9 +511,10 @@ const CGFloat kRapidCloseDistance = 2.5f;
     {
         [self.targetController removePlaceholder];
         self.targetController = newTarget;
+        self.targetPlaceholderFrame = NSZeroRect;
         if( !newTarget )
         {
-            self.tearTime = [NSDate timeIntervalSinceReferenceDate];
+            self.tearTime = [AVTFrameClock sharedClock].now;
             self.tearOrigin = [self.dragWindow frame].origin;
         }
     }
@@ -485,6 +526,8 @@ const CGFloat kRapidCloseDistance = 2.5f;
         // Get rid of any placeholder remaining in the original source window.
 
         [self.sourceController removePlaceholder];
+        if( self.targetController == self.sourceController )
+            self.targetPlaceholderFrame = NSZeroRect;
 
         // Detach from the current window and put it in a new window. If there are no more tabs remaining after detaching, the source window is about to
         // go away (it's been autoreleased) so we need to ensure we don't reference it any more. In that case the new controller becomes our source
@@ -513,7 +556,7 @@ const CGFloat kRapidCloseDistance = 2.5f;
 
         self.draggedController.didShowNewTabButtonBeforeTemporalAction = self.draggedController.showsAddTabButton;
         self.draggedController.showsAddTabButton = NO;
-        self.tearTime = [NSDate timeIntervalSinceReferenceDate];
+        self.tearTime = [AVTFrameClock sharedClock].now;
         self.tearOrigin = self.sourceWindowFrame.origin;
     }
 
@@ -523,47 +566,21 @@ const CGFloat kRapidCloseDistance = 2.5f;
 
     if( self.draggedController && self.sourceController )
     {
-        // When the user first tears off the window, we want slide the window to the current mouse location (to reduce the jarring appearance).
-        // We do this by calling ourselves back with additional mouseDragged calls (not actual events). |tearProgress| is a normalized measure of
-        // how far through this  tear "animation" (of length kTearDuration) we are and has values [0..1].
-        // We use sqrt() so the animation is non-linear (slow down near the end point).
-
-        NSTimeInterval tearProgress = [NSDate timeIntervalSinceReferenceDate] - self.tearTime;
-        tearProgress /= kTearDuration;  // Normalize.
-        tearProgress = sqrtf( MAX( MIN( tearProgress, 1.0 ), 0.0 ) );
-
-        // Move the dragged window to the right place on the screen.
-
-        NSPoint origin = self.sourceWindowFrame.origin;
-        origin.x += (thisPoint.x - self.dragOrigin.x);
-        origin.y += (thisPoint.y - self.dragOrigin.y);
-
-        if( tearProgress < 1 )
-        {
-            // If the tear animation is not complete, call back to ourself with the same event to animate even if the mouse isn't moving. We need to make
-            // sure these get cancelled in mouseUp:.
-
-            [NSObject cancelPreviousPerformRequestsWithTarget: self];
-            [self performSelector: @selector( mouseDragged: )
-                       withObject: theEvent
-                       afterDelay: 1.0f / 30.0f];
-
-            // Set the current window origin based on how far we've progressed through the tear animation.
-
-            origin.x = (1 - tearProgress) * self.tearOrigin.x + tearProgress * origin.x;
-            origin.y = (1 - tearProgress) * self.tearOrigin.y + tearProgress * origin.y;
-        }
-
-        if( self.targetController )
-        {
-            // In order to "snap" two windows of different sizes together at their toolbar, we can't just use the origin of the target frame.
-            // We also have  to take into consideration the difference in height.
-
-            NSRect targetFrame = self.targetController.window.frame;
-            NSRect sourceFrame = self.dragWindow.frame;
-            origin.y = NSMinY( targetFrame ) + (NSHeight( targetFrame ) - NSHeight( sourceFrame ) );
-        }
-        [self.dragWindow setFrameOrigin: NSMakePoint( origin.x, origin.y )];
+        // Move the dragged window to the right place on the screen: under the mouse. When the user first tears off the window, we want to
+        // slide the window there (to reduce the jarring appearance). The slide is run by the frame clock, which moves the window and
+        // any placeholder following it, and nothing else (see |-frameClock:tickAtTime:|), every frame until it catches up with the
+        // mouse, even if the mouse isn't moving.
+
+        NSPoint destination = self.sourceWindowFrame.origin;
+        destination.x += (thisPoint.x - self.dragOrigin.x);
+        destination.y += (thisPoint.y - self.dragOrigin.y);
+        self.tearDestination = destination;
+
+        AVTFrameClock* clock = [AVTFrameClock sharedClock];
+        NSTimeInterval now = clock.now;
+        [self.dragWindow setFrameOrigin: [self dragWindowOriginAtTime: now]];
+        if( now - self.tearTime < kTearDuration )
+            [clock activateClient: self];
 
         // If we're not hovering over any window, make the window fully opaque. Otherwise, find where the tab might be dropped and insert
         // a placeholder so it appears like it's part of that window.
@@ -575,15 +592,7 @@ const CGFloat kRapidCloseDistance = 2.5f;
                 [self.targetController.window orderFront: nil];
             }
 
-            // Compute where placeholder should go and insert it into the destination tab strip.
-
-            AVTTabView* draggedTabView = (AVTTabView*)[self.draggedController selectedTabView];
-            NSRect tabFrame = draggedTabView.frame;
-            tabFrame.origin = [self.dragWindow convertBaseToScreen: tabFrame.origin];
-            tabFrame.origin = [self.targetController.window convertScreenToBase: tabFrame.origin];
-            tabFrame = [self.targetController.tabWellView  convertRect: tabFrame fromView: nil];
-            [self.targetController insertPlaceholderForTab: self frame: tabFrame yStretchiness: 0];
-            [self.targetController layoutTabs];
+            [self insertPlaceholderIntoTarget];
         }
         else
         {
@@ -605,9 +614,9 @@ const CGFloat kRapidCloseDistance = 2.5f;
 
     if( !self.moveWindowOnDrag )
     {
-        // Cancel any delayed -mouseDragged: requests that may still be pending.
+        // Stop the tear animation if it's still running.
 
-        [NSObject cancelPreviousPerformRequestsWithTarget: self];
+        [[AVTFrameClock sharedClock] deactivateClient: self];
 
         // TODO(pinkerton): http://crbug.com/25682 demonstrates a way to get here by some weird circumstance that doesn't first go
         // through mouseDown:. We really shouldn't go any farther.
@@ -675,6 +684,67 @@ const CGFloat kRapidCloseDistance = 2.5f;
     }
 }
 
+// Returns where the dragged window goes at |time|. |tearProgress| is a normalized measure of how far through the tear "animation" (of
+// length kTearDuration) we are and has values [0..1]. We use sqrt() so the animation is non-linear (slow down near the end point).
+
+- (NSPoint) dragWindowOriginAtTime: (NSTimeInterval) time
+{
+    NSTimeInterval tearProgress = time - self.tearTime;
+    tearProgress /= kTearDuration;  // Normalize.
+    tearProgress = sqrt( MAX( MIN( tearProgress, 1.0 ), 0.0 ) );
+
+    // Set the current window origin based on how far we've progressed through the tear animation.
+
+    NSPoint origin = self.tearDestination;
+    origin.x = (1 - tearProgress) * self.tearOrigin.x + tearProgress * origin.x;
+    origin.y = (1 - tearProgress) * self.tearOrigin.y + tearProgress * origin.y;
+
+    if( self.targetController )
+    {
+        // In order to "snap" two windows of different sizes together at their toolbar, we can't just use the origin of the target frame.
+        // We also have  to take into consideration the difference in height.
+
+        NSRect targetFrame = self.targetController.window.frame;
+        NSRect sourceFrame = self.dragWindow.frame;
+        origin.y = NSMinY( targetFrame ) + (NSHeight( targetFrame ) - NSHeight( sourceFrame ) );
+    }
+
+    return origin;
+}
+
+// Compute where placeholder should go and insert it into the destination tab strip. The strip lays itself out as needed. Nothing
+// is done if the placeholder is already there.
+
+- (void) insertPlaceholderIntoTarget
+{
+    AVTTabView* draggedTabView = (AVTTabView*)[self.draggedController selectedTabView];
+    NSRect tabFrame = draggedTabView.frame;
+    tabFrame.origin = [self.dragWindow convertBaseToScreen: tabFrame.origin];
+    tabFrame.origin = [self.targetController.window convertScreenToBase: tabFrame.origin];
+    tabFrame = [self.targetController.tabWellView  convertRect: tabFrame fromView: nil];
+    if( NSEqualRects( tabFrame, self.targetPlaceholderFrame ) )
+        return;
+
+    self.targetPlaceholderFrame = tabFrame;
+    [self.targetController insertPlaceholderForTab: self frame: tabFrame yStretchiness: 0];
+}
+
+// Frame clock callback while the torn off window slides under the mouse. Only the window moves, along with the placeholder
+// following it in a target strip once the slide has carried it somewhere new; finding drop targets and the rest of the drag
+// handling wait for real mouse events.
+
+- (BOOL) frameClock: (AVTFrameClock*) clock tickAtTime: (NSTimeInterval) time
+{
+    if( !self.dragWindow )
+        return NO;
+
+    [self.dragWindow setFrameOrigin: [self dragWindowOriginAtTime: time]];
+    if( self.targetController )
+        [self insertPlaceholderIntoTarget];
+
+    return time - self.tearTime < kTearDuration;
+}
+
 - (void) otherMouseUp: (NSEvent*) theEvent
 {
     if( [self isClosing] == NO )
@@ -697,137 +767,134 @@ const CGFloat kRapidCloseDistance = 2.5f;
 
 - (void) drawRect: (NSRect) dirtyRect
 {
-    // If this tab is phantom, do not draw the tab background itself. The only UI
-    // element that will represent this tab is the favicon.
-
-    NSGraphicsContext* context = [NSGraphicsContext currentContext];
-    [context saveGraphicsState];
-    [context setPatternPhase: [self.window themePatternPhase]];
+    // A tab well that draws its tabs in one pass has already drawn this one underneath us.
 
-    NSRect rect = self.bounds;
-    NSBezierPath* path = [self bezierPathForRect: rect];
-
-    BOOL selected = self.state;
+    if( [self isDrawnByTabWell] )
+        return;
 
-    // Don't draw the window/tab bar background when selected, since the tab background overlay drawn over it (see below) will be fully opaque.
+    [self drawTab];
+}
 
-    if( !selected )
-    {
-        // Use the window's background color rather than |[NSColor windowBackgroundColor]|, which gets confused by the fullscreen
-        // window. (The result is the same for normal, non-fullscreen windows.)
+- (BOOL) isDrawnByTabWell
+{
+    if( ![AVTTabWellView drawsTabsInStrip] || self.layer != nil || ![self.superview isKindOfClass: [AVTTabWellView class]] )
+        return NO;
 
-        [[self.window backgroundColor] set];
-        [path fill];
-        [[NSColor colorWithCalibratedWhite: 1.0 alpha: 0.3] set];
-        [path fill];
-    }
+    return [(AVTTabWellView*)self.superview drawsTabView: self];
+}
 
-    [context saveGraphicsState];
-    [path addClip];
+- (BOOL) shapeIntersectsRect: (NSRect) rect
+{
+    NSRect bounds = self.bounds;
+    rect = NSIntersectionRect( rect, bounds );
+    if( NSIsEmptyRect( rect ) )
+        return NO;
 
-    // Use the same overlay for the selected state and for hover and alert glows; for the selected state, it's fully opaque.
+    // The sides slant inwards from the bottom corners to the top ones (see |-buildBezierPathForRect:|), so the tab is widest
+    // at the bottom of |rect|.
 
-    if( selected || self.hoverAlpha > 0 || self.alertAlpha > 0 )
-    {
-        // Draw the selected background / glow overlay.
+    CGFloat height = NSHeight( bounds );
+    CGFloat rise = MAX( NSMinY( rect ) - NSMinY( bounds ) - 2, 0 ) / MAX( height - 2, 1 );
+    CGFloat inset = rise * kInsetMultiplier * height;
 
-        [context saveGraphicsState];
-        CGContextRef cgContext = [context graphicsPort];
-        CGContextBeginTransparencyLayer( cgContext, 0 );
+    return NSMaxX( rect ) > NSMinX( bounds ) + inset && NSMinX( rect ) < NSMaxX( bounds ) - inset;
+}
 
-        if( !selected )
-        {
-            // The alert glow overlay is like the selected state but at most at most 80% opaque. The hover glow brings up the overlay's opacity at most 50%.
+- (void) drawTab
+{
+    NSGraphicsContext* context = [NSGraphicsContext currentContext];
+    [context saveGraphicsState];
+    [context setPatternPhase: [self.window themePatternPhase]];
 
-            CGFloat backgroundAlpha = 0.8 * self.alertAlpha;
-            backgroundAlpha += (1 - backgroundAlpha) * 0.5 * self.hoverAlpha;
-            CGContextSetAlpha( cgContext, backgroundAlpha );
-        }
-        [path addClip];
-        [context saveGraphicsState];
-        [super drawBackground];
-        [context restoreGraphicsState];
+    NSRect rect = self.bounds;
 
-        // Draw a mouse hover gradient for the default themes.
+    // While the tab is being resized, by a layout animation or a live resize of the window, every frame is at a size that won't
+    // be drawn again, so draw directly rather than build paths and render bitmaps only to throw them away.
 
-        if( !selected && self.hoverAlpha > 0 )
-        {
-            NSGradient* glow =  [[NSGradient alloc] initWithStartingColor: [NSColor colorWithCalibratedWhite: 1.0 alpha: 1.0 * self.hoverAlpha]
-                                                              endingColor: [NSColor colorWithCalibratedWhite: 1.0 alpha: 0.0]];
-
-            NSPoint point = self.hoverPoint;
-            point.y = NSHeight( rect );
-            [glow drawFromCenter: point
-                          radius: 0.0
-                        toCenter: point
-                          radius: NSWidth( rect ) / 3.0
-                         options: NSGradientDrawsBeforeStartingLocation];
-
-            [glow drawInBezierPath: path relativeCenterPosition: self.hoverPoint];
-            [glow release];
-        }
+    BOOL useCache = sDrawsFromCache && !self.sizeChangedSinceDraw && ![self inLiveResize];
+    self.sizeChangedSinceDraw = NO;
 
-        CGContextEndTransparencyLayer( cgContext );
-        [context restoreGraphicsState];
-    }
+    NSBezierPath* path = useCache ? [self bezierPathForRect: rect] : [self buildBezierPathForRect: rect];
 
+    BOOL selected = self.state;
     BOOL active = [self.window isKeyWindow] || [self.window isMainWindow];
-    CGFloat borderAlpha = selected ? (active ? 0.3 : 0.2) : 0.2;
+    CGFloat scale = self.window ? [self.window backingScaleFactor] : 1.0f;
 
-    // TODO: cache colors
+    // The alert glow overlay is like the selected state but at most at most 80% opaque. The hover glow brings up the overlay's
+    // opacity at most 50%. Cached backgrounds are rendered at a fixed number of overlay levels.
 
-    NSColor* borderColor = [NSColor colorWithDeviceWhite: 0.0 alpha: borderAlpha];
-    NSColor* highlightColor = [NSColor colorWithCalibratedWhite: 0xf7 / 255.0 alpha: 1.0];
+    CGFloat overlayAlpha = 1;
+    if( !selected )
+    {
+        overlayAlpha = 0.8 * self.alertAlpha;
+        overlayAlpha += (1 - overlayAlpha) * 0.5 * self.hoverAlpha;
+    }
 
-    // Draw the top inner highlight within the currently selected tab if using
-    // the default theme.
+    // A pattern background has to line up with the rest of the window, which a bitmap rendered once and drawn at every tab
+    // position can't do, so themed windows draw the background directly.
 
-    if( selected )
+    BOOL cacheBackground = useCache && ![[[self.window backgroundColor] colorSpaceName] isEqualToString: NSPatternColorSpace];
+    if( cacheBackground )
     {
-        NSAffineTransform* highlightTransform = [NSAffineTransform transform];
-        [highlightTransform translateXBy: 1.0 yBy: -1.0];
-        NSBezierPath* highlightPath = [path copy];
-        [highlightPath transformUsingAffineTransform: highlightTransform];
-        [highlightColor setStroke];
-        [highlightPath setLineWidth: 1.0];
-        [highlightPath stroke];
-        highlightTransform = [NSAffineTransform transform];
-        [highlightTransform translateXBy: -2.0 yBy: 0.0];
-        [highlightPath transformUsingAffineTransform: highlightTransform];
-        [highlightPath stroke];
-        [highlightPath release];
-    }
+        NSInteger overlayLevel = lround( overlayAlpha * kOverlayLevels );
 
-    [context restoreGraphicsState];
+        // The background gradient is positioned relative to the top of the window.
 
-    // Draw the top stroke.
+        CGFloat topInWindow = NSHeight( self.window.frame ) - NSMaxY( [self convertRect: rect toView: nil] );
 
-    [context saveGraphicsState];
-    [borderColor set];
-    path.lineWidth = 1.0f;
-    [path stroke];
-    [context restoreGraphicsState];
+        NSArray* key = AVTTabBitmapKey( eTabBitmapBackground, rect.size, scale, selected, self.window.isKeyWindow, overlayLevel, topInWindow, [self.window backgroundColor] );
+        CGImageRef background = [sBitmapCache imageForKey: key
+                                                     size: rect.size
+                                                    scale: scale
+                                                  drawing: ^{
+            [self drawBackgroundInPath: path selected: selected overlayAlpha: (CGFloat)overlayLevel / kOverlayLevels];
+        }];
+        AVTDrawBitmap( background, rect );
+    }
+    else
+    {
+        [self drawBackgroundInPath: path selected: selected overlayAlpha: overlayAlpha];
+    }
 
-    // Mimic the tab strip's bottom border, which consists of a dark border
-    // and light highlight.
+    // The hover glow follows the mouse, so it is always drawn directly, on top of the background.
 
-    if( !selected )
+    if( !selected && self.hoverAlpha > 0 )
     {
+        [context saveGraphicsState];
         [path addClip];
-        NSRect borderRect = rect;
-        borderRect.origin.y = 1;
-        borderRect.size.height = 1;
-        [borderColor set];
-        NSRectFillUsingOperation( borderRect, NSCompositeSourceOver );
+        [self drawHoverGlowInPath: path alpha: overlayAlpha * self.hoverAlpha];
+        [context restoreGraphicsState];
+    }
 
-        borderRect.origin.y = 0;
-        [highlightColor set];
-        NSRectFillUsingOperation( borderRect, NSCompositeSourceOver );
+    if( useCache )
+    {
+        NSArray* key = AVTTabBitmapKey( eTabBitmapBorder, rect.size, scale, selected, active, 0, 0, nil );
+        CGImageRef border = [sBitmapCache imageForKey: key
+                                                 size: rect.size
+                                                scale: scale
+                                              drawing: ^{
+            [self drawBorderInPath: [[path copy] autorelease] selected: selected active: active];
+        }];
+        AVTDrawBitmap( border, rect );
+    }
+    else
+    {
+        [self drawBorderInPath: [[path copy] autorelease] selected: selected active: active];
     }
 
     [context restoreGraphicsState];
 }
 
++ (BOOL) drawsFromCache
+{
+    return sDrawsFromCache;
+}
+
++ (void) setDrawsFromCache: (BOOL) drawsFromCache
+{
+    sDrawsFromCache = drawsFromCache;
+}
+
 - (void) viewDidMoveToWindow
 {
     [super viewDidMoveToWindow];
@@ -867,17 +934,12 @@ const CGFloat kRapidCloseDistance = 2.5f;
     if( self.alertState != eAlertNone )
     {
         self.alertState = eAlertFalling;
-        self.alertHoldEndTime = [NSDate timeIntervalSinceReferenceDate] + kGlowUpdateInterval;
+        self.alertHoldEndTime = [AVTTabGlowAnimator sharedAnimator].clock.now + kGlowUpdateInterval;
         [self resetLastGlowUpdateTime];
         [self adjustGlowValue];
     }
 }
 
-- (void) setTrackingEnabled: (BOOL) enabled
-{
-    [self.closeButton setTrackingEnabled: enabled];
-}
-
 - (BOOL) accessibilityIsIgnored
 {
     return NO;
@@ -941,117 +1003,189 @@ const CGFloat kRapidCloseDistance = 2.5f;
 
 - (void) resetLastGlowUpdateTime
 {
-    self.lastGlowUpdate = [NSDate timeIntervalSinceReferenceDate];
+    self.lastGlowUpdate = [AVTTabGlowAnimator sharedAnimator].clock.now;
 }
 
-- (NSTimeInterval) timeElapsedSinceLastGlowUpdate
+// Steps the glow to now, and hands it to the glow animator if it is still changing.
+
+- (void) adjustGlowValue
 {
-    return [NSDate timeIntervalSinceReferenceDate] - self.lastGlowUpdate;
+    AVTTabGlowAnimator* animator = [AVTTabGlowAnimator sharedAnimator];
+
+    if( [self advanceGlowToTime: animator.clock.now] )
+        [animator startAnimatingTabView: self];
+    else
+        [animator stopAnimatingTabView: self];
 }
 
-- (void) adjustGlowValue
+- (BOOL) advanceGlowToTime: (NSTimeInterval) time
 {
-    // A time interval long enough to represent no update.
-    const NSTimeInterval kNoUpdate = 1000000;
+    AVTTabGlowState state;
+    state.mouseInside = self.mouseInside;
+    state.hoverAlpha = self.hoverAlpha;
+    state.hoverHoldEndTime = self.hoverHoldEndTime;
+    state.alertState = self.alertState;
+    state.alertAlpha = self.alertAlpha;
+    state.alertHoldEndTime = self.alertHoldEndTime;
 
-    // Time until next update for either glow.
-    NSTimeInterval nextUpdate = kNoUpdate;
+    NSTimeInterval nextUpdate = AVTTabGlowStep( &state, time, time - self.lastGlowUpdate );
 
-    NSTimeInterval elapsed = [self timeElapsedSinceLastGlowUpdate];
-    NSTimeInterval currentTime = [NSDate timeIntervalSinceReferenceDate];
+    // Only redraw when one of the glows actually moved; holds tick by without drawing.
+
+    BOOL changed = state.hoverAlpha != self.hoverAlpha || state.alertAlpha != self.alertAlpha;
+
+    self.hoverAlpha = state.hoverAlpha;
+    self.hoverHoldEndTime = state.hoverHoldEndTime;
+    self.alertState = state.alertState;
+    self.alertAlpha = state.alertAlpha;
+    self.alertHoldEndTime = state.alertHoldEndTime;
+    self.lastGlowUpdate = time;
+
+    if( changed )
+        [self setNeedsDisplay: YES];
+
+    return nextUpdate < kGlowNoUpdate;
+}
 
-    // TODO(viettrungluu): <http://crbug.com/30617> -- split off the stuff below
-    // into a pure function and add a unit test.
+// Draws the tab's fill: the window background for unselected tabs, then the selected background at |overlayAlpha| (which is 1
+// for the selected tab, and the strength of the alert and hover glows for the others).
 
-    if( self.isMouseInside )
+- (void) drawBackgroundInPath: (NSBezierPath*) path
+                     selected: (BOOL) selected
+                 overlayAlpha: (CGFloat) overlayAlpha
+{
+    NSGraphicsContext* context = [NSGraphicsContext currentContext];
+
+    // Don't draw the window/tab bar background when selected, since the tab background overlay drawn over it (see below) will be fully opaque.
+
+    if( !selected )
     {
-        // Increase hover glow until it's 1.
-        if( self.hoverAlpha < 1 )
-        {
-            self.hoverAlpha = MIN( self.hoverAlpha + elapsed / kHoverShowDuration, 1 );
-            nextUpdate = MIN( kGlowUpdateInterval, nextUpdate );
-        }  // Else already 1 (no update needed).
+        // Use the window's background color rather than |[NSColor windowBackgroundColor]|, which gets confused by the fullscreen
+        // window. (The result is the same for normal, non-fullscreen windows.)
+
+        [[self.window backgroundColor] set];
+        [path fill];
+        [sUnselectedFillColor set];
+        [path fill];
     }
-    else
+
+    // Use the same overlay for the selected state and for hover and alert glows; for the selected state, it's fully opaque.
+
+    if( overlayAlpha > 0 )
     {
-        if( currentTime >= self.hoverHoldEndTime )
-        {
-            // No longer holding, so decrease hover glow until it's 0.
-            if( self.hoverAlpha > 0 )
-            {
-                self.hoverAlpha = MAX( self.hoverAlpha - elapsed / kHoverHideDuration, 0 );
-                nextUpdate = MIN( kGlowUpdateInterval, nextUpdate );
-            }  // Else already 0 (no update needed).
-        }
-        else
-        {
-            // Schedule update for end of hold time.
-            nextUpdate = MIN( self.hoverHoldEndTime - currentTime, nextUpdate );
-        }
+        [context saveGraphicsState];
+        CGContextRef cgContext = [context graphicsPort];
+        CGContextSetAlpha( cgContext, overlayAlpha );
+        CGContextBeginTransparencyLayer( cgContext, 0 );
+        [path addClip];
+        [super drawBackground];
+        CGContextEndTransparencyLayer( cgContext );
+        [context restoreGraphicsState];
     }
+}
 
-    if( self.alertState == eAlertRising )
-    {
-        // Increase alert glow until it's 1 ...
+// Draw a mouse hover gradient for the default themes.
 
-        self.alertAlpha = MIN( self.alertAlpha + elapsed / kAlertShowDuration, 1 );
+- (void) drawHoverGlowInPath: (NSBezierPath*) path
+                       alpha: (CGFloat) alpha
+{
+    NSRect rect = self.bounds;
+    NSPoint point = self.hoverPoint;
+    point.y = NSHeight( rect );
 
-        // ... and having reached 1, switch to holding.
+    CGContextSetAlpha( [[NSGraphicsContext currentContext] graphicsPort], alpha );
+    [sHoverGlow drawFromCenter: point
+                        radius: 0.0
+                      toCenter: point
+                        radius: NSWidth( rect ) / 3.0
+                       options: NSGradientDrawsBeforeStartingLocation];
 
-        if( self.alertAlpha >= 1 )
-        {
-            self.alertState = eAlertHolding;
-            self.alertHoldEndTime = currentTime + kAlertHoldDuration;
-            nextUpdate = MIN( kAlertHoldDuration, nextUpdate );
-        }
-        else
-        {
-            nextUpdate = MIN( kGlowUpdateInterval, nextUpdate );
-        }
-    }
-    else if( self.alertState != eAlertNone )
+    [sHoverGlow drawInBezierPath: path relativeCenterPosition: self.hoverPoint];
+}
+
+// Draws the top inner highlight of the selected tab, the outline, and for unselected tabs the tab strip's bottom border.
+// |path| is modified.
+
+- (void) drawBorderInPath: (NSBezierPath*) path
+                 selected: (BOOL) selected
+                   active: (BOOL) active
+{
+    NSGraphicsContext* context = [NSGraphicsContext currentContext];
+    NSColor* borderColor = selected && active ? sActiveBorderColor : sBorderColor;
+
+    // Draw the top inner highlight within the currently selected tab if using
+    // the default theme.
+
+    if( selected )
     {
-        if( self.alertAlpha > 0 )
-        {
-            if( currentTime >= self.alertHoldEndTime )
-            {
-                // Stop holding, then decrease alert glow (until it's 0).
-                if( self.alertState == eAlertHolding )
-                {
-                    self.alertState = eAlertFalling;
-                    nextUpdate = MIN( kGlowUpdateInterval, nextUpdate );
-                }
-                else
-                {
-                    self.alertAlpha = MAX( self.alertAlpha - elapsed / kAlertHideDuration, 0 );
-                    nextUpdate = MIN( kGlowUpdateInterval, nextUpdate );
-                }
-            }
-            else
-            {
-                // Schedule update for end of hold time.
+        [context saveGraphicsState];
+        [path addClip];
 
-                nextUpdate = MIN( self.alertHoldEndTime - currentTime, nextUpdate );
-            }
-        }
-        else
-        {
-            // Done the alert decay cycle.
+        NSAffineTransform* highlightTransform = [NSAffineTransform transform];
+        [highlightTransform translateXBy: 1.0 yBy: -1.0];
+        NSBezierPath* highlightPath = [path copy];
+        [highlightPath transformUsingAffineTransform: highlightTransform];
+        [sHighlightColor setStroke];
+        [highlightPath setLineWidth: 1.0];
+        [highlightPath stroke];
+        highlightTransform = [NSAffineTransform transform];
+        [highlightTransform translateXBy: -2.0 yBy: 0.0];
+        [highlightPath transformUsingAffineTransform: highlightTransform];
+        [highlightPath stroke];
+        [highlightPath release];
 
-            self.alertState = eAlertNone;
-        }
+        [context restoreGraphicsState];
     }
 
-    if( nextUpdate < kNoUpdate )
-        [self performSelector: _cmd withObject: nil afterDelay: nextUpdate];
+    // Draw the top stroke.
 
-    [self resetLastGlowUpdateTime];
-    [self setNeedsDisplay: YES];
+    [context saveGraphicsState];
+    [borderColor set];
+    path.lineWidth = 1.0f;
+    [path stroke];
+    [context restoreGraphicsState];
+
+    // Mimic the tab strip's bottom border, which consists of a dark border
+    // and light highlight.
+
+    if( !selected )
+    {
+        [context saveGraphicsState];
+        [path addClip];
+        NSRect borderRect = self.bounds;
+        borderRect.origin.y = 1;
+        borderRect.size.height = 1;
+        [borderColor set];
+        NSRectFillUsingOperation( borderRect, NSCompositeSourceOver );
+
+        borderRect.origin.y = 0;
+        [sHighlightColor set];
+        NSRectFillUsingOperation( borderRect, NSCompositeSourceOver );
+        [context restoreGraphicsState];
+    }
 }
 
-// Returns the bezier path used to draw the tab given the bounds to draw it in.
+// Returns the bezier path used to draw the tab given the bounds to draw it in. Nearly all tabs share a few sizes, so paths are
+// built once per size and kept in a cache. The path is shared with every tab of that size, so callers must not modify it; copy
+// it first.
 
 - (NSBezierPath*) bezierPathForRect: (NSRect) rect
+{
+    NSValue* key = [NSValue valueWithRect: rect];
+    NSBezierPath* path = sPathCache[key];
+    if( path == nil )
+    {
+        if( sPathCache.count >= kPathCacheCapacity )
+            [sPathCache removeAllObjects];
+
+        path = [self buildBezierPathForRect: rect];
+        sPathCache[key] = path;
+    }
+
+    return path;
+}
+
+- (NSBezierPath*) buildBezierPathForRect: (NSRect) rect
 {
     // Outset by 0.5 in order to draw on pixels rather than on borders (which
     // would cause blurry pixels). Subtract 1px of height to compensate, otherwise
@@ -1089,3 +1223,33 @@ const CGFloat kRapidCloseDistance = 2.5f;
 }
 
 @end
+
+NSArray* AVTTabBitmapKey( AVTTabBitmapKind kind, NSSize size, CGFloat scale, BOOL selected, BOOL active, NSInteger overlayLevel, CGFloat topInWindow, NSColor* backgroundColor )
+{
+    // The geometry and state are compared byte for byte, so clear the padding. The background color goes in by value next to
+    // them, so equal colors share bitmaps and the key keeps its color alive.
+
+    struct
+    {
+        AVTTabBitmapKind kind;
+        NSSize size;
+        CGFloat scale;
+        BOOL selected;
+        BOOL active;
+        NSInteger overlayLevel;
+        CGFloat topInWindow;
+
+    } key;
+    memset( &key, 0, sizeof( key ) );
+
+    key.kind = kind;
+    key.size = size;
+    key.scale = scale;
+    key.selected = selected;
+    key.active = active;
+    key.overlayLevel = overlayLevel;
+    key.topInWindow = topInWindow;
+
+    NSData* data = [NSData dataWithBytes: &key length: sizeof( key )];
+    return @[data, backgroundColor ?: [NSNull null]];
+}
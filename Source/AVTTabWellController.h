@@ -84,6 +84,10 @@ static const NSTimeInterval kAnimationDuration = 0.125;
 
 - (NSView*) viewAtIndex: (NSInteger) index;
 
+// Update the throbber or crashed icon of the tab of |document| to match its loading state. Does nothing if it isn't in this well.
+
+- (void) updateLoadingStateForDocument: (AVTTabDocument*) document;
+
 // Set the placeholder for a dragged tab, allowing the |frame| and |strechiness| to be specified. This causes this tab to be rendered in an arbitrary position
 
 - (void) insertPlaceholderForTab: (AVTTabView*) tab frame: (NSRect) frame yStretchiness: (CGFloat) yStretchiness;
@@ -97,10 +101,23 @@ static const NSTimeInterval kAnimationDuration = 0.125;
 
 @property (nonatomic, readonly) BOOL tabDraggingAllowed;
 
-// When we're told to layout from the public API we usually want to animate, except when it's the first time.
+// When we're told to layout from the public API we usually want to animate, except when it's the first time. Lays out immediately.
 
 - (void) layoutTabs;
 
+// Request a layout. Requests are merged and performed once at the end of the current run loop turn.
+
+- (void) setNeedsTabLayout;
+
+// Perform a requested layout now, if there is one. For code that needs up to date tab geometry.
+
+- (void) layoutTabsIfNeeded;
+
+// Layouts requested during a live resize are held to one per display frame. Called when the resize ends to lay out for the final
+// size right away, without animation.
+
+- (void) layoutTabsAfterLiveResize;
+
 @property (nonatomic, assign) AVTTabWellView* tabWellView;          // Weak
 @property (nonatomic, assign) AVTFastResizeView* switchView;        // Weak
 @property (nonatomic, assign) AVTContainer* container;              // Weak
@@ -112,24 +129,7 @@ static const NSTimeInterval kAnimationDuration = 0.125;
 
 @property (nonatomic, retain) NSView* dragBlockingView;             // Avoid bad window server drags.
 
-// Access to the TabContentsControllers (which own the parent view for the toolbar and associated tab contents) given an index.
-// Call |indexFromModelIndex:| to convert a |tabWellModel| index to a |tabDocumentArray| index. Do NOT assume that the indices of
-// |tabWellModel| and this array are identical, this is e.g. not true while tabs are animating closed (closed tabs are removed
-// from |tabWellModel| immediately, but from |tabDocumentArray| only after their close animation has completed).
-
-@property (nonatomic, retain) NSMutableArray* tabDocumentArray;
-
-// An array of TabControllers which manage the actual tab views. See note above |tabDocumentArray|. |tabDocumentArray| and
-// |tabArray| always contain objects belonging to the same tabs at the same indices.
-
-@property (nonatomic, retain) NSMutableArray* tabArray;
-
-// Set of TabControllers that are currently animating closed.
-
-@property (nonatomic, retain) NSMutableSet* closingControllers;
-
 @property (nonatomic, retain) AVTNewTabButton* addTabButton;
-@property (nonatomic, retain) NSTrackingArea* addTabTrackingArea;
 
 @property (nonatomic, assign) AVTTabView* placeholderTab;           // Weak. Tab being dragged
 @property (nonatomic, assign) NSRect placeholderFrame;              // Frame to use
@@ -146,7 +146,8 @@ static const NSTimeInterval kAnimationDuration = 0.125;
 
 @property (nonatomic, assign) CGFloat availableResizeWidth;
 
-// A tracking area that's the size of the tab strip used to be notified when the mouse moves in the tab strip
+// A tracking area that's the size of the tab strip used to be notified when the mouse moves in the tab strip. This is the only
+// tracking area in the well: hover for the tabs, their close buttons and the new tab button is computed from it.
 
 @property (nonatomic, retain) NSTrackingArea* trackingArea;
 @property (nonatomic, assign) AVTTabView* hoveredTab;               // Weak. Tab that the mouse is hovering over
@@ -172,4 +173,13 @@ static const NSTimeInterval kAnimationDuration = 0.125;
 
 @property (nonatomic, retain) AVTWindowSheetController* sheetController;
 
+// The number of layouts requested (through |-setNeedsTabLayout| and friends) and the number actually performed.
+
+@property (nonatomic, readonly) NSUInteger tabLayoutRequestCount;
+@property (nonatomic, readonly) NSUInteger tabLayoutRunCount;
+
+// The number of placeholder moves during tab drags that were handled without a layout, moving only the tabs the placeholder passed.
+
+@property (nonatomic, readonly) NSUInteger placeholderMoveCount;
+
 @end
@@ -11,14 +11,17 @@
 #import "AVTContainer.h"
 #import "AVTContainerCommands.h"
 #import "AVTFastResizeView.h"
+#import "AVTFrameClock.h"
+#import "AVTHoverCloseButton.h"
 #import "AVTNewTabButton.h"
+#import "AVTTabAnimationTimeline.h"
 #import "AVTTabController.h"
 #import "AVTTabDocument.h"
 #import "AVTTabDocumentController.h"
+#import "AVTTabIconView.h"
 #import "AVTTabView.h"
 #import "AVTTabWellModel.h"
 #import "AVTTabWellView.h"
-#import "AVTThrobberView.h"
 #import "NSAnimationContext+Duration.h"
 
 // The images names used for different states of the new tab button.
@@ -33,29 +36,42 @@ NSImage* sDefaultIconImage = nil;
 
 static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChanged";
 
-// A delegate, owned by the CAAnimation system, that is alerted when the animation to close a tab is completed. Calls back to the given tab well
-// to let it know that |controller| is ready to be removed from the model. Since we only maintain weak references, the tab well must call -invalidate:
-// to prevent the use of dangling pointers.
+// How long (in seconds) after the last close rapid closure mode lasts if the mouse stays in the tab well.
 
-@interface TabCloseAnimationDelegate : NSObject
+static const NSTimeInterval kRapidClosureTimeout = 1.5;
 
-// Will tell |well| when the animation for |controller|'s view has completed. These should not be nil, and will not be retained.
+// Everything the tab well knows about one tab, kept in a single record so that a layout pass walks one contiguous block of
+// memory instead of several collections that have to be kept in lockstep. Slots are ordered the same way as the tabs in the
+// well, which is the model order plus any tabs that are still animating closed (see the comment above the class extension).
 
-- (id) initWithTabWell: (AVTTabWellController*) well tabController: (AVTTabController*) controller;
+typedef struct
+{
+    AVTTabController* tabController;                // Retained. Manages the tab view.
+    AVTTabDocumentController* documentController;   // Retained. Owns the parent view for the toolbar and tab contents.
+    BOOL closing;                                   // Animating closed; no longer present in the model.
+    BOOL hasTargetFrame;                            // |targetFrame| has been set.
+    NSRect targetFrame;                             // The frame last given to the view (or the animation timeline).
+    NSRect currentFrame;                            // The frame computed for the tab by the most recent layout pass.
 
-// Invalidates this object so that no further calls will be made to |well|.  This should be called when |well| is released, to
-// prevent attempts to call into the released object.
+} AVTTabSlot;
 
-- (void) invalidate;
+// The number of slots allocated up front. The array grows geometrically from there.
 
-// CAAnimation delegate method
+static const NSUInteger kInitialSlotCapacity = 16;
 
-- (void) animationDidStop: (CAAnimation*) animation finished: (BOOL) finished;
+// One entry in the offset index, the left-to-right ordered list of laid out tabs used to answer "which tab is at x" questions
+// by binary search instead of walking every tab (or every subview).
 
-@property (nonatomic, assign) AVTTabWellController* well;
-@property (nonatomic, assign) AVTTabController* controller;
+typedef struct
+{
+    CGFloat minX;                                   // Left edge of the tab's laid out frame, in tab well coordinates.
+    CGFloat maxX;                                   // Right edge of the tab's laid out frame.
+    NSUInteger slotIndex;                           // The slot holding the tab.
 
-@end
+} AVTTabOffset;
+
+static NSUInteger AVTCountOfOffsetsBefore( const AVTTabOffset* offsets, NSUInteger count, CGFloat x, BOOL inclusive );
+static NSUInteger AVTIndexOfPlaceholderGap( const AVTTabOffset* offsets, NSUInteger count, CGFloat x, NSUInteger gapIndex, CGFloat gapWidth );
 
 // A simple view class that prevents the Window Server from dragging the area behind tabs. Sometimes core animation confuses it.
 // Unfortunately, it can also falsely pick up clicks during rapid tab closure, so we have to account for that.
@@ -70,7 +86,7 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
 
 // In general, there is a one-to-one correspondence between TabControllers, TabViews, TabDocumentControllers, and the
 // AVTTabDocument in the TabWellModel. In the steady-state, the indices line up so an index coming from the model is
-// directly mapped to the same index in the parallel arrays holding our views and controllers. This is also true when new
+// directly mapped to the same index in the slot array holding our views and controllers. This is also true when new
 // tabs are created (even though there is a small period of animation) because the tab is present in the model while the
 // AVTTabView is animating into place. As a result, nothing special need be done to handle "new tab" animation.
 //
@@ -78,13 +94,13 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
 // with the notification that the tab has been removed from the model. The simplest solution at this point would be to remove
 // the views and controllers as well, however once the AVTTabView is removed from the view list, the tab z-order code takes
 // care of removing it from the tab well and we'll get no animation. That means if there is to be any visible animation, the
-// AVTTabView needs to stay around until its animation is complete. In order to maintain consistency among the internal parallel
-// arrays, this means all structures are kept around until the animation completes. At this point, though, the model and our
+// AVTTabView needs to stay around until its animation is complete. In order to keep the slot array consistent, this means the
+// tab's slot is kept around (marked as closing) until the animation completes. At this point, though, the model and our
 // internal structures are out of sync: the indices no longer line up. As a result, there is a concept of a "model index" which
-// represents an index valid in the TabWellModel. During steady-state, the "model index" is just the same index as our parallel
-// arrays (as above), but during tab close animations, it is different, offset by the number of tabs preceding the index which
+// represents an index valid in the TabWellModel. During steady-state, the "model index" is just the same index as our slot
+// array (as above), but during tab close animations, it is different, offset by the number of tabs preceding the index which
 // are undergoing tab closing animation. As a result, the caller needs to be careful to use the available conversion routines
-// when accessing the internal parallel arrays (e.g., -indexFromModelIndex:). Care also needs to be taken during tab layout to
+// when accessing the slot array (e.g., -indexFromModelIndex:). Care also needs to be taken during tab layout to
 // ignore closing tabs in the total width calculations and in individual tab positioning (to avoid moving them right back to
 /// where they were).
 //
@@ -93,29 +109,89 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
 // disabled while there are tabs closing.
 
 @interface AVTTabWellController()
+{
+    AVTTabSlot* _slots;             // One record per tab in the well, see |AVTTabSlot|.
+    NSUInteger _slotCount;
+    NSUInteger _slotCapacity;
+    NSUInteger _closingSlotCount;   // Number of slots with |closing| set.
+
+    AVTTabOffset* _offsets;         // Laid out, non-closing tabs in left-to-right order (minus the placeholder).
+    NSUInteger _offsetCount;
+    NSUInteger _offsetCapacity;
+    NSInteger _selectedOffsetSlot;  // Slot of the selected tab when the index was built, or kNoTab.
+    BOOL _offsetIndexValid;
+
+    // Where the placeholder sits in the laid out strip while a tab is being dragged, see |-movePlaceholderGap|.
+
+    BOOL _dragGapValid;             // The fields below describe the current geometry.
+    NSInteger _dragPlaceholderSlot; // Slot of the placeholder tab if it belongs to this well, or kNoTab.
+    NSUInteger _dragGapIndex;       // The offset index entry the gap opens before, |_offsetCount| if it's at the end.
+    CGFloat _dragGapWidth;          // How far the tabs after the gap are pushed right.
+}
+
+- (AVTTabSlot*) slotAtIndex: (NSUInteger) index;
+- (NSInteger) slotIndexForTabController: (AVTTabController*) controller;
+- (void) insertSlotWithTabController: (AVTTabController*) tabController documentController: (AVTTabDocumentController*) documentController atIndex: (NSUInteger) index;
+- (AVTTabDocumentController*) documentControllerAtModelIndex: (NSInteger) modelIndex;
+- (void) removeSlotAtIndex: (NSUInteger) index;
+- (void) moveSlotFromIndex: (NSUInteger) from toIndex: (NSUInteger) to;
+
+- (void) rebuildOffsetIndexIfNeeded;
+- (NSInteger) slotIndexOfTabAtPoint: (NSPoint) point;
+
+- (void) movePlaceholderGap;
 
 - (void) layoutTabsWithAnimation: (BOOL) animate regenerateSubviews: (BOOL) doUpdate;
+- (void) setNeedsTabLayoutWithAnimation: (BOOL) animate regenerateSubviews: (BOOL) doUpdate;
+- (void) setNeedsDefaultTabLayoutRegeneratingSubviews: (BOOL) doUpdate;
+- (void) scheduleTabLayoutRegeneratingSubviews: (BOOL) doUpdate;
 - (void) regenerateSubviewList;
+- (void) updateZOrderForTab: (AVTTabController*) controller;
 
 - (NSInteger) numberOfOpenTabs;
 - (NSInteger) numberOfOpenMiniTabs;
 - (NSInteger) numberOfOpenNonMiniTabs;
 
 - (void) setAddTabButtonHoverState: (BOOL) showHover;
-- (void) setTabTrackingAreasEnabled: (BOOL) enabled;
+- (void) endRapidClosureMode;
+- (void) updateHoverAtLocation: (NSPoint) location;
+- (void) clearHover;
 
 @property (nonatomic, assign) BOOL initialLayoutComplete;
 
+// A layout has been requested but not run yet, along with the merged options of every request since the last layout.
+
+@property (nonatomic, assign) BOOL tabLayoutPending;
+@property (nonatomic, assign) BOOL pendingLayoutAnimates;
+@property (nonatomic, assign) BOOL pendingLayoutSuppressesAnimation;
+@property (nonatomic, assign) BOOL pendingLayoutRegeneratesSubviews;
+
+@property (nonatomic, assign) NSUInteger tabLayoutRequestCount;
+@property (nonatomic, assign) NSUInteger tabLayoutRunCount;
+@property (nonatomic, assign) NSUInteger placeholderMoveCount;
+
+// The close button the mouse is over, if any. Hover for tabs and their close buttons is computed by the well from its single
+// tracking area, so only the tabs whose state actually changes are told about it.
+
+@property (nonatomic, assign) AVTHoverCloseButton* hoveredCloseButton;  // Weak
+
 // If YES, do not show the new tab button during layout.
 
 @property (nonatomic, assign) BOOL forceAddTabButtonHidden;
 
-// Frame targets for all the current views. target frames are used because repeated requests to [NSView animator].
-// aren't coalesced, so we store frames to avoid redundant calls.
+// Frame target for the new tab button. Target frames are stored so a layout that doesn't move anything doesn't restart
+// animations. The tabs keep theirs in their slots.
 
-@property (nonatomic, retain) NSMutableDictionary* targetFrames;
 @property (nonatomic, assign) NSRect addTabTargetFrame;
 
+// Animates every tab and the new tab button. See |AVTTabAnimationTimeline|.
+
+@property (nonatomic, retain) AVTTabAnimationTimeline* animationTimeline;
+
+// When the most recent layout pass ran, for throttling layouts during live resize.
+
+@property (nonatomic, assign) CFAbsoluteTime lastLayoutTime;
+
 @end
 
 @implementation AVTTabWellController
@@ -172,12 +248,13 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
 
         _defaultIcon = [sDefaultIconImage retain];
 
-        _tabDocumentArray = [[NSMutableArray alloc] init];
-        _tabArray = [[NSMutableArray alloc] init];
+        _slotCapacity = kInitialSlotCapacity;
+        _slots = calloc( _slotCapacity, sizeof( AVTTabSlot ) );
 
-        _closingControllers = [[NSMutableSet alloc] init];
-
-        _targetFrames = [[NSMutableDictionary alloc] init];
+        _offsetCapacity = kInitialSlotCapacity;
+        _offsets = calloc( _offsetCapacity, sizeof( AVTTabOffset ) );
+        _selectedOffsetSlot = kNoTab;
+        _dragPlaceholderSlot = kNoTab;
 
         _availableResizeWidth = kUseFullAvailableWidth;
         _indentForControls = [[self class] defaultIndentForControls];
@@ -197,17 +274,14 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
         [_addTabButton setImage: sAddTabImage];
         [_addTabButton setAlternateImage: sAddTabPressedImage];
         _addTabButtonShowingHoverImage = NO;
-        _addTabTrackingArea = [[NSTrackingArea alloc] initWithRect: _addTabButton.bounds
-                                                           options: (NSTrackingMouseEnteredAndExited | NSTrackingActiveAlways)
-                                                             owner: self
-                                                          userInfo: nil];
-        [_addTabButton addTrackingArea: _addTabTrackingArea];
 
         _dragBlockingView = [[AVTTabWellControllerDragBlockingView alloc] initWithFrame: NSZeroRect controller: self];
         [self addSubviewToPermanentList: _dragBlockingView];
 
         _addTabTargetFrame = NSZeroRect;
 
+        _animationTimeline = [[AVTTabAnimationTimeline alloc] initWithFrameClock: [AVTFrameClock sharedClock]];
+
         // Install the permanent subviews.
 
         [self regenerateSubviewList];
@@ -225,33 +299,34 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
                                                     userInfo: nil];
         [_tabWellView addTrackingArea: _trackingArea];
 
-        // Check to see if the mouse is currently in our bounds so we can enable the tracking areas.  Otherwise we won't get hover states
+        // Check to see if the mouse is currently in our bounds so hover is computed from the start. Otherwise we won't get hover states
         // or tab gradients if we load the window up under the mouse.
 
         NSPoint mouseLoc = [tabWellView.window mouseLocationOutsideOfEventStream];
         mouseLoc = [tabWellView convertPoint: mouseLoc fromView: nil];
         if( NSPointInRect( mouseLoc, tabWellView.bounds ) )
-        {
-            [self setTabTrackingAreasEnabled: YES];
             _mouseInside = YES;
-        }
 
         [[NSNotificationCenter defaultCenter] addObserver: self
                                                  selector: @selector( tabInserted: )
                                                      name: kDidInsertTabDocumentNotification
-                                                   object: nil];
+                                                   object: _tabWellModel];
+        [[NSNotificationCenter defaultCenter] addObserver: self
+                                                 selector: @selector( tabsInserted: )
+                                                     name: kDidInsertTabDocumentsNotification
+                                                   object: _tabWellModel];
         [[NSNotificationCenter defaultCenter] addObserver: self
                                                  selector: @selector( tabSelected: )
                                                      name: kDidSelectTabDocumentNotification
-                                                   object: nil];
+                                                   object: _tabWellModel];
         [[NSNotificationCenter defaultCenter] addObserver: self
                                                  selector: @selector( tabDetached: )
                                                      name: kDidDetachTabDocumentNotification
-                                                   object: nil];
+                                                   object: _tabWellModel];
         [[NSNotificationCenter defaultCenter] addObserver: self
                                                  selector: @selector( tabMoved: )
                                                      name: kTabDocumentDidMoveNotification
-                                                   object: nil];
+                                                   object: _tabWellModel];
     }
 
     return self;
@@ -263,18 +338,27 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
     _placeholderTab = nil;
     _tabWellModel = nil;
     _hoveredTab = nil;
+    _hoveredCloseButton = nil;
 
     [_permanentSubviews release];
     [_defaultIcon release];
     [_dragBlockingView release];
-    [_tabDocumentArray release];
-    [_tabArray release];
-    [_closingControllers release];
     [_addTabButton release];
-    [_addTabTrackingArea release];
-    [_targetFrames release];
     [_trackingArea release];
 
+    // Drop in-flight animations, including the completions of closing tabs that would call back into us.
+
+    [_animationTimeline invalidate];
+    [_animationTimeline release];
+
+    for( NSUInteger i = 0; i < _slotCount; ++i )
+    {
+        [_slots[i].tabController release];
+        [_slots[i].documentController release];
+    }
+    free( _slots );
+    free( _offsets );
+
     [super dealloc];
 }
 
@@ -290,56 +374,31 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
 
 // Find the model index based on the x coordinate of the placeholder. If there is no placeholder, this returns the end of the
 // tab strip. Closing tabs are not considered in computing the index.
+//
+// Closing tabs and the placeholder tab itself are left out of the offset index, so the answer is simply the number of indexed
+// tabs that start to the left of the placeholder. The only drawback of ignoring closing tabs is that if the placeholder is placed
+// right before one or several contiguous currently closing tabs, the associated AVTTabController will start at the end of the
+// closing tabs.
 
 - (int) indexOfPlaceholder
 {
-    double placeholderX = self.placeholderFrame.origin.x;
-    int index = 0;
-    int location = 0;
-
-    // Use |tabArray| here instead of the tab strip count in order to get the
-    // correct index when there are closing tabs to the left of the placeholder.
-
-    const NSUInteger count = self.tabArray.count;
-    while( index < count )
-    {
-        // Ignore closing tabs for simplicity. The only drawback of this is that
-        // if the placeholder is placed right before one or several contiguous
-        // currently closing tabs, the associated CTTabController will start at the
-        // end of the closing tabs.
-
-        if( [self.closingControllers containsObject: [self.tabArray objectAtIndex: index]] )
-        {
-            index++;
-            continue;
-        }
-        NSView* curr = [self viewAtIndex: index];
+    [self rebuildOffsetIndexIfNeeded];
 
-        // The placeholder tab works by changing the frame of the tab being dragged to be the bounds of the placeholder,
-        // so we need to skip it while we're iterating, otherwise we'll end up off by one.  Note This only effects
-        // dragging to the right, not to the left.
-
-        if( curr == self.placeholderTab )
-        {
-            index++;
-            continue;
-        }
-
-        if( placeholderX <= NSMinX( [curr frame] ) )
-            break;
-        index++;
-        location++;
-    }
-
-    return location;
+    return (int)AVTCountOfOffsetsBefore( _offsets, _offsetCount, self.placeholderFrame.origin.x, NO );
 }
 
 - (void) setFrameOfSelectedTab: (NSRect) frame
 {
-    NSView* view = [self selectedTabView];
-    NSValue* identifier = [NSValue valueWithPointer: view];
-    [self.targetFrames setObject: [NSValue valueWithRect: frame] forKey: identifier];
-    [view setFrame: frame];
+    NSInteger index = [self indexFromModelIndex: [self.tabWellModel selectedIndex]];
+    if( index >= 0 && index < _slotCount )
+    {
+        AVTTabSlot* slot = &_slots[index];
+        slot->targetFrame = frame;
+        slot->hasTargetFrame = YES;
+        slot->currentFrame = frame;
+        _offsetIndexValid = NO;
+        [self.animationTimeline setFrame: frame ofView: [slot->tabController view]];
+    }
 }
 
 // (Private) Returns the number of open tabs in the tab well. This is the number of TabControllers we know about
@@ -355,7 +414,7 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
 - (NSInteger) numberOfOpenMiniTabs
 {
     // Ask the model for the number of mini tabs. Note that tabs which are in the process of closing (i.e., whose controllers are in
-    // |closingControllers|) have already been removed from the model.
+    // closing slots) have already been removed from the model.
 
     return [self.tabWellModel indexOfFirstNonMiniTab];
 }
@@ -368,55 +427,204 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
     return number;
 }
 
-#pragma mark - Mouse Tracking
+#pragma mark - Slots
 
-- (void) mouseEntered: (NSEvent*) event
+// Returns the slot at |index|. The pointer is only valid until the next insertion or removal.
+
+- (AVTTabSlot*) slotAtIndex: (NSUInteger) index
 {
-    NSTrackingArea* area = event.trackingArea;
-    if( [area isEqual: self.trackingArea] )
+    NSAssert( index < _slotCount, @"Slot index out of range." );
+
+    return &_slots[index];
+}
+
+// Returns the index of the slot holding |controller|, or kNoTab if there isn't one.
+
+- (NSInteger) slotIndexForTabController: (AVTTabController*) controller
+{
+    for( NSUInteger i = 0; i < _slotCount; ++i )
     {
-        self.mouseInside = YES;
-        [self setTabTrackingAreasEnabled: YES];
-        [self mouseMoved: event];
+        if( _slots[i].tabController == controller )
+            return i;
+    }
+
+    return kNoTab;
+}
+
+- (void) insertSlotWithTabController: (AVTTabController*) tabController
+                  documentController: (AVTTabDocumentController*) documentController
+                             atIndex: (NSUInteger) index
+{
+    NSAssert( index <= _slotCount, @"Slot index out of range." );
+
+    if( _slotCount == _slotCapacity )
+    {
+        _slotCapacity *= 2;
+        _slots = realloc( _slots, _slotCapacity * sizeof( AVTTabSlot ) );
     }
+
+    memmove( &_slots[index + 1], &_slots[index], (_slotCount - index) * sizeof( AVTTabSlot ) );
+    ++_slotCount;
+
+    AVTTabSlot* slot = &_slots[index];
+    memset( slot, 0, sizeof( AVTTabSlot ) );
+    slot->tabController = [tabController retain];
+    slot->documentController = [documentController retain];
+
+    _offsetIndexValid = NO;
+    _dragGapValid = NO;
 }
 
-- (void) mouseMoved: (NSEvent*) event
+- (void) removeSlotAtIndex: (NSUInteger) index
 {
-    // Use hit test to figure out what view we are hovering over.
+    NSAssert( index < _slotCount, @"Slot index out of range." );
 
-    NSView* targetView = [self.tabWellView hitTest: event.locationInWindow];
+    AVTTabSlot slot = _slots[index];
+    memmove( &_slots[index], &_slots[index + 1], (_slotCount - index - 1) * sizeof( AVTTabSlot ) );
+    --_slotCount;
 
-    // Set the new tab button hover state iff the mouse is over the button.
+    if( slot.closing )
+        --_closingSlotCount;
 
-    BOOL shouldShowHoverImage = [targetView isKindOfClass: [AVTNewTabButton class]];
-    [self setAddTabButtonHoverState: shouldShowHoverImage];
+    _offsetIndexValid = NO;
+    _dragGapValid = NO;
 
-    AVTTabView* tabView = (AVTTabView*)targetView;
-    if( ![tabView isKindOfClass: [AVTTabView class]] )
+    [slot.tabController release];
+    [slot.documentController release];
+}
+
+- (void) moveSlotFromIndex: (NSUInteger) from
+                   toIndex: (NSUInteger) to
+{
+    NSAssert( from < _slotCount && to < _slotCount, @"Slot index out of range." );
+
+    AVTTabSlot slot = _slots[from];
+    if( from < to )
+        memmove( &_slots[from], &_slots[from + 1], (to - from) * sizeof( AVTTabSlot ) );
+    else if( from > to )
+        memmove( &_slots[to + 1], &_slots[to], (from - to) * sizeof( AVTTabSlot ) );
+    _slots[to] = slot;
+
+    _offsetIndexValid = NO;
+    _dragGapValid = NO;
+}
+
+// Returns the document controller of the tab at |modelIndex|. Tabs inserted in a batch don't have one until something needs
+// their contents, usually when they are first selected; it is created here.
+
+- (AVTTabDocumentController*) documentControllerAtModelIndex: (NSInteger) modelIndex
+{
+    AVTTabSlot* slot = [self slotAtIndex: [self indexFromModelIndex: modelIndex]];
+    if( slot->documentController == nil )
     {
-        if( [[tabView superview] isKindOfClass: [AVTTabView class]] )
-        {
-            tabView = (AVTTabView*)[targetView superview];
-        }
-        else
-        {
-            tabView = nil;
-        }
+        AVTTabDocument* document = [self.tabWellModel tabDocumentAtIndex: modelIndex];
+        slot->documentController = [[self.container createTabDocumentControllerWithDocument: document] retain];
     }
 
-    if( self.hoveredTab != tabView )
+    return slot->documentController;
+}
+
+#pragma mark - Offset Index
+
+// Rebuild the offset index from the frames computed by the last layout pass. Layout rebuilds it as it finishes, anything that
+// changes the slots in between just marks it as stale.
+
+- (void) rebuildOffsetIndexIfNeeded
+{
+    if( _offsetIndexValid )
+        return;
+
+    if( _offsetCapacity < _slotCount )
     {
-        [self.hoveredTab mouseExited: nil];  // We don't pass event because moved events
-        [tabView mouseEntered: nil];  // don't have valid tracking areas
-        self.hoveredTab = tabView;
+        _offsetCapacity = _slotCapacity;
+        _offsets = realloc( _offsets, _offsetCapacity * sizeof( AVTTabOffset ) );
     }
-    else
+
+    _offsetCount = 0;
+    _selectedOffsetSlot = kNoTab;
+
+    for( NSUInteger i = 0; i < _slotCount; ++i )
+    {
+        const AVTTabSlot* slot = &_slots[i];
+
+        // Closing tabs are no longer in the model and tabs that haven't been laid out yet have no position.
+
+        if( slot->closing || NSIsEmptyRect( slot->currentFrame ) )
+            continue;
+
+        if( [slot->tabController selected] )
+            _selectedOffsetSlot = i;
+
+        // The placeholder follows the mouse so it would break the ordering. It is always the selected tab and is found that way.
+
+        if( [slot->tabController view] == self.placeholderTab )
+            continue;
+
+        AVTTabOffset* offset = &_offsets[_offsetCount++];
+        offset->minX = NSMinX( slot->currentFrame );
+        offset->maxX = NSMaxX( slot->currentFrame );
+        offset->slotIndex = i;
+    }
+
+    _offsetIndexValid = YES;
+}
+
+// Returns the slot of the tab under |point| (in tab well coordinates), or kNoTab. Mirrors the hit testing of AVTTabView, which
+// insets the hit rect by a third of the height to remove most of the overlap between adjacent tabs, and the z-order of the
+// well: the selected tab is on top and otherwise tabs on the left are above those on their right.
+
+- (NSInteger) slotIndexOfTabAtPoint: (NSPoint) point
+{
+    [self rebuildOffsetIndexIfNeeded];
+
+    const CGFloat height = [[self class] defaultTabHeight] + 1;
+    if( point.y < 0 || point.y >= height )
+        return kNoTab;
+
+    const CGFloat inset = height / 3.0f;
+
+    if( _selectedOffsetSlot != kNoTab )
+    {
+        NSRect frame = _slots[_selectedOffsetSlot].currentFrame;
+        if( point.x >= NSMinX( frame ) + inset && point.x < NSMaxX( frame ) - inset )
+            return _selectedOffsetSlot;
+    }
+
+    // Every tab that could contain the point starts at or to the left of it. Since right edges are ordered as well, walk left
+    // from there for as long as the tabs still cover the point and keep the leftmost (topmost) one. Only overlapping neighbours
+    // are visited, so this is constant time after the search.
+
+    NSInteger hitSlot = kNoTab;
+    NSInteger i = (NSInteger)AVTCountOfOffsetsBefore( _offsets, _offsetCount, point.x - inset, YES ) - 1;
+    for( ; i >= 0 && _offsets[i].maxX - inset > point.x; --i )
+        hitSlot = _offsets[i].slotIndex;
+
+    return hitSlot;
+}
+
+#pragma mark - Mouse Tracking
+
+// The well has a single tracking area covering the whole tab well view. Tabs, their close buttons and the new tab button don't
+// track the mouse themselves; hover for all of them is derived from the layout geometry here, and only the tabs whose hover state
+// changes are told about it.
+
+- (void) mouseEntered: (NSEvent*) event
+{
+    NSTrackingArea* area = event.trackingArea;
+    if( [area isEqual: self.trackingArea] )
     {
-        [self.hoveredTab mouseMoved: event];
+        self.mouseInside = YES;
+        [self mouseMoved: event];
     }
 }
 
+- (void) mouseMoved: (NSEvent*) event
+{
+    NSPoint location = [self.tabWellView convertPoint: event.locationInWindow fromView: nil];
+    [self updateHoverAtLocation: location];
+    [self.hoveredTab mouseMoved: event];
+}
+
 // Called when the tracking area is in effect which means we're tracking to see if the user leaves the tab well with their mouse.
 // When they do, reset layout to use all available width.
 
@@ -426,46 +634,65 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
     if( [area isEqual: self.trackingArea] )
     {
         self.mouseInside = NO;
-        [self setTabTrackingAreasEnabled: NO];
-        self.availableResizeWidth = kUseFullAvailableWidth;
-        [self.hoveredTab mouseExited: event];
-        self.hoveredTab = nil;
-        [self layoutTabs];
+        [self clearHover];
+        [self endRapidClosureMode];
     }
-    else if( [area isEqual: self.addTabTrackingArea] )
-    {
-        // If the mouse is moved quickly enough, it is possible for the mouse to leave the tabwell without sending any
-        // mouseMoved: messages at all. Since this would result in the new tab button incorrectly staying in the
-        // hover state, disable the hover image on every mouse exit.
+}
+
+// Work out which tab, close button and new tab button are under |location| (in tab well coordinates) and push any changes to the
+// views involved: at most the previously and newly hovered tab and close button.
+
+- (void) updateHoverAtLocation: (NSPoint) location
+{
+    // Use the offset index to figure out what tab we are hovering over rather than hit testing every subview.
 
-        [self setAddTabButtonHoverState: NO];
+    NSInteger slotIndex = [self slotIndexOfTabAtPoint: location];
+    AVTTabView* tabView = (slotIndex == kNoTab) ? nil : _slots[slotIndex].tabController.tabView;
+
+    // Set the new tab button hover state iff the mouse is over the button. Tabs are above the button, so they win.
+
+    BOOL shouldShowHoverImage = tabView == nil && ![self.addTabButton isHidden] && [self.addTabButton pointIsOverButton: location];
+    [self setAddTabButtonHoverState: shouldShowHoverImage];
+
+    if( self.hoveredTab != tabView )
+    {
+        [self.hoveredTab mouseExited: nil];  // We don't pass event because moved events
+        [tabView mouseEntered: nil];  // don't have valid tracking areas
+        self.hoveredTab = tabView;
     }
+
+    // The close button is the only part of a tab with its own hover state.
+
+    AVTHoverCloseButton* closeButton = tabView.closeButton;
+    if( closeButton && ( [closeButton isHidden] || !NSPointInRect( [tabView convertPoint: location fromView: self.tabWellView], closeButton.frame ) ) )
+        closeButton = nil;
+    self.hoveredCloseButton = closeButton;
 }
 
-// Enable/Disable the tracking areas for the tabs. They are only enabled when the mouse is in the tabwell.
+- (void) clearHover
+{
+    [self setAddTabButtonHoverState: NO];
+    self.hoveredCloseButton = nil;
+    [self.hoveredTab mouseExited: nil];
+    self.hoveredTab = nil;
+}
 
-- (void) setTabTrackingAreasEnabled: (BOOL) enabled
+- (void) setHoveredCloseButton: (AVTHoverCloseButton*) closeButton
 {
-    NSNotificationCenter* defaultCenter = [NSNotificationCenter defaultCenter];
-    for( AVTTabController* controller in self.tabArray )
+    // Leave a button that is being pressed alone, it is tracking the mouse itself until the click completes.
+
+    if( _hoveredCloseButton != closeButton && _hoveredCloseButton.hoverState == eHoverStateMouseOver )
     {
-        AVTTabView* tabView = controller.tabView;
-        if( enabled )
-        {
-            // Set self up to observe tabs so hover states will be correct.
+        _hoveredCloseButton.hoverState = eHoverStateNone;
+        [_hoveredCloseButton setNeedsDisplay: YES];
+    }
 
-            [defaultCenter addObserver: self
-                              selector: @selector( tabUpdateTracking: )
-                                  name: NSViewDidUpdateTrackingAreasNotification
-                                object: tabView];
-        }
-        else
-        {
-            [defaultCenter removeObserver: self
-                                     name: NSViewDidUpdateTrackingAreasNotification
-                                   object: tabView];
-        }
-        [tabView setTrackingEnabled: enabled];
+    _hoveredCloseButton = closeButton;
+
+    if( closeButton.hoverState == eHoverStateNone && closeButton != nil )
+    {
+        closeButton.hoverState = eHoverStateMouseOver;
+        [closeButton setNeedsDisplay: YES];
     }
 }
 
@@ -497,11 +724,103 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
 
 #pragma mark - Layout
 
-// When we're told to layout from the public API we usually want to animate, except when it's the first time.
+// When we're told to layout from the public API we usually want to animate, except when it's the first time. The z-order of the
+// tabs is maintained incrementally as tabs are inserted, selected, moved and removed (see |-updateZOrderForTab:|), so a regular
+// layout leaves the subview list alone. This lays out immediately, absorbing any pending request.
 
 - (void) layoutTabs
 {
-    [self layoutTabsWithAnimation: self.initialLayoutComplete regenerateSubviews: YES];
+    [self setNeedsTabLayout];
+    [self layoutTabsIfNeeded];
+}
+
+// Request a layout with the default options. See |-setNeedsTabLayoutWithAnimation:regenerateSubviews:|.
+
+- (void) setNeedsTabLayout
+{
+    [self setNeedsDefaultTabLayoutRegeneratingSubviews: NO];
+}
+
+// Request a layout at the end of the current run loop turn. A single model change usually produces several requests (an insert
+// in the foreground is followed by a select, the container lays out the window, and so on), so requests are merged and the layout
+// runs once. It regenerates the subviews if any request asked for that. It animates if a request asked for animation, unless a
+// request explicitly asked for none: a frame change has to be followed at once, whatever else asked for a layout in the same
+// turn. Default requests (|-setNeedsTabLayout|) animate once the initial layout is done, but never override an explicit NO. The
+// layout is performed in the common modes so it also happens during live resize and drag tracking. During live resize every
+// resize step is a run loop turn of its own, so layouts are also held to one per display frame; the container window controller
+// lays the tabs out for the final size when the resize ends.
+
+- (void) setNeedsTabLayoutWithAnimation: (BOOL) animate
+                     regenerateSubviews: (BOOL) doUpdate
+{
+    self.tabLayoutRequestCount++;
+
+    if( animate )
+        self.pendingLayoutAnimates = YES;
+    else
+        self.pendingLayoutSuppressesAnimation = YES;
+
+    [self scheduleTabLayoutRegeneratingSubviews: doUpdate];
+}
+
+// A request with the default animation: none before the initial layout, which doesn't count as asking for none.
+
+- (void) setNeedsDefaultTabLayoutRegeneratingSubviews: (BOOL) doUpdate
+{
+    self.tabLayoutRequestCount++;
+
+    if( self.initialLayoutComplete )
+        self.pendingLayoutAnimates = YES;
+
+    [self scheduleTabLayoutRegeneratingSubviews: doUpdate];
+}
+
+- (void) scheduleTabLayoutRegeneratingSubviews: (BOOL) doUpdate
+{
+    self.pendingLayoutRegeneratesSubviews = self.pendingLayoutRegeneratesSubviews || doUpdate;
+
+    if( !self.tabLayoutPending )
+    {
+        NSTimeInterval delay = 0;
+        if( [self.tabWellView inLiveResize] )
+            delay = MAX( 0, self.lastLayoutTime + [AVTFrameClock sharedClock].interval - CFAbsoluteTimeGetCurrent() );
+
+        self.tabLayoutPending = YES;
+        [self performSelector: @selector( layoutTabsIfNeeded )
+                   withObject: nil
+                   afterDelay: delay
+                      inModes: @[NSRunLoopCommonModes]];
+    }
+}
+
+// Lay out for the window's final size, without animation, once a live resize is over. The explicit NO also overrides the default
+// request the container makes as it lays out the window for the final size.
+
+- (void) layoutTabsAfterLiveResize
+{
+    [self setNeedsTabLayoutWithAnimation: NO regenerateSubviews: NO];
+    [self layoutTabsIfNeeded];
+}
+
+// Run a pending layout right away. Used by code that needs the geometry to be current, such as the drag and drop code.
+
+- (void) layoutTabsIfNeeded
+{
+    if( self.tabLayoutPending )
+    {
+        [NSObject cancelPreviousPerformRequestsWithTarget: self selector: @selector( layoutTabsIfNeeded ) object: nil];
+
+        // Tabs follow a live resize directly; animating them would only make them trail the window edge.
+
+        BOOL animate = self.pendingLayoutAnimates && !self.pendingLayoutSuppressesAnimation && ![self.tabWellView inLiveResize];
+        BOOL doUpdate = self.pendingLayoutRegeneratesSubviews;
+        self.tabLayoutPending = NO;
+        self.pendingLayoutAnimates = NO;
+        self.pendingLayoutSuppressesAnimation = NO;
+        self.pendingLayoutRegeneratesSubviews = NO;
+
+        [self layoutTabsWithAnimation: animate regenerateSubviews: doUpdate];
+    }
 }
 
 // Lay out all tabs in the order of their TabDocumentControllers, which matches the ordering in the TabWellModel.
@@ -515,7 +834,9 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
               regenerateSubviews: (BOOL) doUpdate
 {
     NSAssert( [NSThread isMainThread], @"Must be done on main thread." );
-    if( self.tabArray.count > 0 )
+    self.tabLayoutRunCount++;
+    self.lastLayoutTime = CFAbsoluteTimeGetCurrent();
+    if( _slotCount > 0 )
     {
         const CGFloat kMaxTabWidth = [AVTTabController maxTabWidth];
         const CGFloat kMinTabWidth = [AVTTabController minTabWidth];
@@ -524,11 +845,10 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
         const CGFloat kAppTabWidth = [AVTTabController appTabWidth];
 
         NSRect enclosingRect = NSZeroRect;
-        if( animate )
-        {
-            [NSAnimationContext beginGrouping];
-            [[NSAnimationContext currentContext] avt_setDuration: kAnimationDuration eventMask: NSLeftMouseUpMask];
-        }
+
+        // Everything that moves in this pass animates on the same timeline, for the same (possibly slowed down) duration.
+
+        const NSTimeInterval duration = [NSAnimationContext avt_duration: kAnimationDuration eventMask: NSLeftMouseUpMask];
 
         // Update the current subviews and their z-order if requested.
 
@@ -588,17 +908,23 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
         }
 
         BOOL visible = [[self.tabWellView window] isVisible];
+        AVTTabAnimationTimeline* timeline = self.animationTimeline;
 
         CGFloat offset = [self indentForControls];
         NSUInteger i = 0;
         bool hasPlaceholderGap = false;
-        for( AVTTabController* tab in self.tabArray )
+        NSUInteger placeholderGapIndex = 0;
+        NSInteger placeholderSlot = kNoTab;
+        for( NSUInteger slotIndex = 0; slotIndex < _slotCount; ++slotIndex )
         {
+            AVTTabSlot* slot = &_slots[slotIndex];
+
             // Ignore a tab that is going through a close animation.
 
-            if( [self.closingControllers containsObject: tab] )
+            if( slot->closing )
                 continue;
 
+            AVTTabController* tab = slot->tabController;
             BOOL isPlaceholder = [tab.view isEqual: self.placeholderTab];
             NSRect tabFrame = tab.view.frame;
             tabFrame.size.height = [[self class] defaultTabHeight] + 1;
@@ -616,30 +942,21 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
 
             if( isPlaceholder )
             {
-                // Move the current tab to the correct location instantly.
-                // We need a duration or else it doesn't cancel an inflight animation.
-
-                if( animate )
-                {
-                    [NSAnimationContext beginGrouping];
-                    [[NSAnimationContext currentContext] setDuration: 0.00001];
-                }
+                // Move the current tab to the correct location instantly, cancelling any animation in flight.
 
                 tabFrame.origin.x = self.placeholderFrame.origin.x;
 
                 // TODO(alcor): reenable this
                 // tabFrame.size.height += 10.0 * placeholderStretchiness_;
 
-                id target = animate ?[tab.view animator] : tab.view;
-                [target setFrame: tabFrame];
-
-                // Store the frame by identifier to aviod redundant calls to animator.
+                [timeline setFrame: tabFrame ofView: tab.view];
+                placeholderSlot = slotIndex;
 
-                NSValue* identifier = [NSValue valueWithPointer: tab.view];
-                [self.targetFrames setObject: [NSValue valueWithRect: tabFrame] forKey: identifier];
+                // Store the frame in the slot to avoid redundant animations.
 
-                if( animate )
-                    [NSAnimationContext endGrouping];
+                slot->targetFrame = tabFrame;
+                slot->hasTargetFrame = YES;
+                slot->currentFrame = tabFrame;
 
                 continue;
             }
@@ -653,6 +970,7 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
                 if( NSMidX( tabFrame ) > placeholderMin )
                 {
                     hasPlaceholderGap = true;
+                    placeholderGapIndex = i;
                     offset += NSWidth( self.placeholderFrame );
                     offset -= kTabOverlap;
                     tabFrame.origin.x = offset;
@@ -673,26 +991,27 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
             {
                 if( NSEqualRects( self.droppedTabFrame, NSZeroRect ) )
                 {
-                    [tab.view setFrame: NSOffsetRect( tabFrame, 0, -NSHeight( tabFrame ) )];
+                    [timeline setFrame: NSOffsetRect( tabFrame, 0, -NSHeight( tabFrame ) ) ofView: tab.view];
                 }
                 else
                 {
-                    [tab.view setFrame: self.droppedTabFrame];
+                    [timeline setFrame: self.droppedTabFrame ofView: tab.view];
                     self.droppedTabFrame = NSZeroRect;
                 }
             }
 
-            // Check the frame by identifier to avoid redundant calls to animator.
+            // Check the frame stored in the slot so a tab that isn't moving doesn't have its animation restarted.
 
-            id frameTarget = visible && animate ?[tab.view animator] : tab.view;
-            NSValue* identifier = [NSValue valueWithPointer: tab.view];
-            NSValue* oldTargetValue = [self.targetFrames objectForKey: identifier];
-            if( !oldTargetValue ||
-                !NSEqualRects( [oldTargetValue rectValue], tabFrame ) )
+            if( !slot->hasTargetFrame || !NSEqualRects( slot->targetFrame, tabFrame ) )
             {
-                [frameTarget setFrame: tabFrame];
-                [self.targetFrames setObject: [NSValue valueWithRect: tabFrame] forKey: identifier];
+                if( visible && animate )
+                    [timeline animateView: tab.view toFrame: tabFrame duration: duration completion: nil];
+                else
+                    [timeline setFrame: tabFrame ofView: tab.view];
+                slot->targetFrame = tabFrame;
+                slot->hasTargetFrame = YES;
             }
+            slot->currentFrame = tabFrame;
 
             enclosingRect = NSUnionRect( tabFrame, enclosingRect );
 
@@ -717,7 +1036,7 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
 
             newTabNewFrame.origin = NSMakePoint( offset, 0 );
             newTabNewFrame.origin.x = MAX( newTabNewFrame.origin.x, NSMaxX( self.placeholderFrame ) ) + kAddTabButtonOffset;
-            if( self.tabDocumentArray.count )
+            if( _slotCount )
                 [self.addTabButton setHidden: NO];
 
             if( !NSEqualRects( self.addTabTargetFrame, newTabNewFrame ) )
@@ -731,40 +1050,44 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
                 BOOL shouldShowHover = [self.addTabButton pointIsOverButton: currentMouse];
                 [self setAddTabButtonHoverState: shouldShowHover];
 
-                // Move the new tab button into place. We want to animate the new tab  button if it's moving to the left (closing a tab),
-                // but not when it's moving to the right (inserting a new tab). If moving right, we need to use a very small duration to
-                // make sure we cancel any in-flight  animation to the left.
+                // Move the new tab button into place. We want to animate the new tab button if it's moving to the left (closing a tab),
+                // but not when it's moving to the right (inserting a new tab). Setting the frame directly cancels any in-flight
+                // animation to the left.
 
-                if( visible && animate )
-                {
-                    [NSAnimationContext beginGrouping];
-                    {
-                        BOOL movingLeft = NSMinX( newTabNewFrame ) < NSMinX( self.addTabTargetFrame );
-                        if( !movingLeft && animate )
-                        {
-                            [[NSAnimationContext currentContext] setDuration: 0.00001];
-                        }
-                        [[self.addTabButton animator] setFrame: newTabNewFrame];
-                        self.addTabTargetFrame = newTabNewFrame;
-                    }
-                    [NSAnimationContext endGrouping];
-                }
+                BOOL movingLeft = NSMinX( newTabNewFrame ) < NSMinX( self.addTabTargetFrame );
+                if( visible && animate && movingLeft )
+                    [timeline animateView: self.addTabButton toFrame: newTabNewFrame duration: duration completion: nil];
                 else
-                {
-                    [self.addTabButton setFrame: newTabNewFrame];
-                    self.addTabTargetFrame = newTabNewFrame;
-                }
+                    [timeline setFrame: newTabNewFrame ofView: self.addTabButton];
+                self.addTabTargetFrame = newTabNewFrame;
             }
         }
 
         [self.dragBlockingView setFrame: enclosingRect];
 
+        // Index the new positions for hover, placeholder and drop queries.
+
+        _offsetIndexValid = NO;
+        [self rebuildOffsetIndexIfNeeded];
+
+        // Remember where the placeholder gap ended up so the following drag events can move it without another layout.
+
+        _dragGapValid = self.placeholderTab != nil;
+        _dragPlaceholderSlot = placeholderSlot;
+        _dragGapIndex = hasPlaceholderGap ? placeholderGapIndex : i;
+        _dragGapWidth = NSWidth( self.placeholderFrame ) - kTabOverlap;
+
+        // Tabs may have moved under a stationary mouse, so bring hover up to date with the new geometry.
+
+        if( self.mouseInside )
+        {
+            NSPoint location = [[self.tabWellView window] mouseLocationOutsideOfEventStream];
+            [self updateHoverAtLocation: [self.tabWellView convertPoint: location fromView: nil]];
+        }
+
         // Mark that we've successfully completed layout of at least one tab.
 
         self.initialLayoutComplete = YES;
-
-        if( animate )
-            [NSAnimationContext endGrouping];
     }
 }
 
@@ -772,13 +1095,12 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
 // and putting in the current tabs in the correct z-order. Any current subviews which is neither in the permanent
 // list nor a (current) tab will be removed. So if you add such a subview, you should call |-addSubviewToPermanentList:|
 // (or better yet, call that and then |-regenerateSubviewList| to actually add it).
+//
+// This touches every tab, so it is only the fallback for structural changes such as installing the permanent subviews.
+// Day-to-day changes go through |-updateZOrderForTab:|.
 
 - (void) regenerateSubviewList
 {
-    // Remove self as an observer from all the old tabs before a new set of potentially different tabs is put in place.
-
-    [self setTabTrackingAreasEnabled: NO];
-
     // Subviews to put in (in bottom-to-top order), beginning with the permanent ones.
 
     NSMutableArray* subviews = [NSMutableArray arrayWithArray: self.permanentSubviews];
@@ -787,8 +1109,9 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
 
     // Go through tabs in reverse order, since |subviews| is bottom-to-top.
 
-    for( AVTTabController* tab in [self.tabArray reverseObjectEnumerator] )
+    for( NSInteger i = (NSInteger)_slotCount - 1; i >= 0; --i )
     {
+        AVTTabController* tab = _slots[i].tabController;
         NSView* tabView = [tab view];
         if( [tab selected] )
         {
@@ -805,22 +1128,91 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
         [subviews addObject: selectedTabView];
     }
     [self.tabWellView setSubviews: subviews];
-    [self setTabTrackingAreasEnabled: self.mouseInside];
+}
+
+// Put the view of |controller| into its place in the z-order without disturbing any other tab. Tabs are stacked so that tabs
+// to the left draw above tabs to the right, with the selected tab above all of them and every tab above the permanent subviews.
+// A view that is not yet in the well is added, a view that is already there is moved. The invariant is the same one
+// |-regenerateSubviewList| establishes, so the two can be mixed freely.
+
+- (void) updateZOrderForTab: (AVTTabController*) controller
+{
+    if( controller == nil )
+        return;
+
+    AVTTabWellView* tabWellView = self.tabWellView;
+    NSView* tabView = [controller view];
+
+    if( [controller selected] )
+    {
+        [tabWellView addSubview: tabView positioned: NSWindowAbove relativeTo: nil];
+    }
+    else
+    {
+        // Find the closest tab to the left that is already in the well; we belong directly below it. If there isn't one we
+        // belong below the selected tab, or on top if there is no selected tab yet.
+
+        NSView* relativeView = nil;
+        NSInteger index = [self slotIndexForTabController: controller];
+        NSAssert( index != kNoTab, @"Tab isn't in the slot array." );
+
+        for( NSInteger i = index - 1; i >= 0 && relativeView == nil; --i )
+        {
+            AVTTabController* current = _slots[i].tabController;
+            if( ![current selected] && [[current view] superview] == tabWellView )
+                relativeView = [current view];
+        }
+
+        if( relativeView == nil )
+        {
+            for( NSUInteger i = 0; i < _slotCount; ++i )
+            {
+                AVTTabController* current = _slots[i].tabController;
+                if( current != controller && [current selected] && [[current view] superview] == tabWellView )
+                {
+                    relativeView = [current view];
+                    break;
+                }
+            }
+        }
+
+        if( relativeView )
+            [tabWellView addSubview: tabView positioned: NSWindowBelow relativeTo: relativeView];
+        else
+            [tabWellView addSubview: tabView positioned: NSWindowAbove relativeTo: nil];
+    }
 }
 
 // Are we in rapid (tab) closure mode? I.e., is a full layout deferred (while the user closes tabs)? Needed to overcome missing
 // clicks during rapid tab closure.
+//
+// Closing a tab (other than by dragging) freezes the width available to the tabs (see |-closeTab:|), so the remaining tabs keep
+// their size and the next close button ends up under the mouse. The tabs are only reflowed to the full width once, when the mouse
+// leaves the well or the user stops closing tabs for |kRapidClosureTimeout|.
 
 - (BOOL) inRapidClosureMode
 {
-    return NO;
+    return self.availableResizeWidth != kUseFullAvailableWidth;
+}
+
+// Leave rapid closure mode, if we are in it, and reflow the tabs to the full available width.
+
+- (void) endRapidClosureMode
+{
+    [NSObject cancelPreviousPerformRequestsWithTarget: self selector: @selector( endRapidClosureMode ) object: nil];
+
+    if( [self inRapidClosureMode] )
+    {
+        self.availableResizeWidth = kUseFullAvailableWidth;
+        [self setNeedsTabLayout];
+    }
 }
 
 // Disable tab dragging when there are any pending animations.
 
 - (BOOL) tabDraggingAllowed
 {
-    return self.closingControllers.count == 0;
+    return _closingSlotCount == 0;
 }
 
 #pragma mark - Properties
@@ -859,15 +1251,14 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
     // so it can be looked up later.
 
     AVTTabDocumentController* documentController = [self.container createTabDocumentControllerWithDocument: document];
-    [self.tabDocumentArray insertObject: documentController atIndex: index];
 
-    // Make a new tab and add it to the strip. Keep track of its controller.
+    // Make a new tab and add it to the strip. Keep track of both controllers in the tab's slot.
 
     AVTTabController* newController = [self newTab];
     [newController setMini: [self.tabWellModel isMiniTabForIndex: modelIndex]];
     [newController setPinned: [self.tabWellModel isTabPinnedForIndex: modelIndex]];
     [newController setApp: [self.tabWellModel isAppTabForIndex: modelIndex]];
-    [self.tabArray insertObject: newController atIndex: index];
+    [self insertSlotWithTabController: newController documentController: documentController atIndex: index];
     NSView* newView = [newController view];
 
     // Set the originating frame to just below the strip so that it animates upwards as it's being initially layed out.
@@ -875,19 +1266,20 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
 
     [newView setFrame: NSOffsetRect( [newView frame], 0, -[[self class] defaultTabHeight] )];
 
+    // Slot the new (still hidden) view into the z-order. Only this view is touched, the rest of the well keeps its order.
+
+    [self updateZOrderForTab: newController];
+
     [self setTabTitle: newController withDocument: document];
 
     // If a tab is being inserted, we can again use the entire tab strip width for layout.
 
     self.availableResizeWidth = kUseFullAvailableWidth;
 
-    // We don't need to call |-layoutTabs| if the tab will be in the foreground because it will get called when the new tab is
-    // selected by the tab model. Whenever |-layoutTabs| is called, it'll also add the new subview.
+    // If the tab is in the foreground the tab model is about to select it, which requests a layout of its own. Both requests
+    // are merged into one.
 
-    if( !inForeground )
-    {
-        [self layoutTabs];
-    }
+    [self setNeedsTabLayout];
 
     // During normal loading, we won't yet have a favicon and we'll get subsequent state change notifications to show the
     // throbber, but when we're  dragging a tab out into a new window, we have to put the tab's favicon into the right state
@@ -900,6 +1292,46 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
     [[NSNotificationCenter defaultCenter] postNotificationName: kTabWellNumberOfTabsChanged object: self];
 }
 
+// The model has notified us that a run of tabs was inserted in one go. This does what |-tabInserted:| does for each of them,
+// except that the document controllers are left to |-documentControllerAtModelIndex:|, the z-order is rebuilt once by the
+// layout instead of tab by tab, and there is a single layout request and a single broadcast for the whole run.
+
+- (void) tabsInserted: (NSNotification*) notification
+{
+    NSDictionary* userInfo = notification.userInfo;
+    NSArray* documents = userInfo[kTabDocumentsKey];
+    NSInteger modelIndex = [userInfo[kTabDocumentIndexKey] integerValue];
+
+    NSAssert( documents.count, @"Insert didn't get any documents." );
+    NSAssert( [self.tabWellModel containsIndex: modelIndex], @"Invalid index" );
+
+    NSInteger index = [self indexFromModelIndex: modelIndex];
+    CGFloat tabHeight = [[self class] defaultTabHeight];
+
+    for( AVTTabDocument* document in documents )
+    {
+        AVTTabController* newController = [self newTab];
+        [newController setMini: [self.tabWellModel isMiniTabForIndex: modelIndex]];
+        [newController setPinned: [self.tabWellModel isTabPinnedForIndex: modelIndex]];
+        [newController setApp: [self.tabWellModel isAppTabForIndex: modelIndex]];
+        [self insertSlotWithTabController: newController documentController: nil atIndex: index];
+
+        NSView* newView = [newController view];
+        [newView setFrame: NSOffsetRect( [newView frame], 0, -tabHeight )];
+
+        [self setTabTitle: newController withDocument: document];
+        [self updateIconRepresentationForDocument: document atIndex: modelIndex];
+
+        index++;
+        modelIndex++;
+    }
+
+    self.availableResizeWidth = kUseFullAvailableWidth;
+    [self setNeedsTabLayoutWithAnimation: self.initialLayoutComplete regenerateSubviews: YES];
+
+    [[NSNotificationCenter defaultCenter] postNotificationName: kTabWellNumberOfTabsChanged object: self];
+}
+
 // The model has notified us that a tab was selected.
 
 - (void) tabSelected: (NSNotification*) notification
@@ -917,31 +1349,40 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
         if( oldModelIndex != kNoTab ) // When closing a tab, the old tab may be gone.
         {
             NSInteger oldIndex = [self indexFromModelIndex: oldModelIndex];
-            AVTTabDocumentController* oldController = [self.tabDocumentArray objectAtIndex: oldIndex];
+            AVTTabDocumentController* oldController = [self slotAtIndex: oldIndex]->documentController;
             [oldController willResignSelectedTab];
         }
     }
 
-    // De-select all other tabs and select the new tab.
+    // De-select all other tabs and select the new tab, remembering which tab lost the selection.
 
-    NSInteger i = 0;
-    for( AVTTabController* current in self.tabArray )
+    AVTTabController* previousSelection = nil;
+    for( NSUInteger i = 0; i < _slotCount; ++i )
     {
-        [current setSelected: (i == index) ? YES: NO];
-        ++i;
+        AVTTabController* current = _slots[i].tabController;
+        BOOL selected = (i == index) ? YES : NO;
+        if( [current selected] && !selected )
+            previousSelection = current;
+        [current setSelected: selected];
     }
 
+    // Only the previously and newly selected tabs change their place in the z-order. The new selection is raised to the top
+    // first, so that an old selection without a tab to its left drops back directly below the new one rather than below a
+    // view that is about to move.
+
+    [self updateZOrderForTab: [self slotAtIndex: index]->tabController];
+    [self updateZOrderForTab: previousSelection];
+
     // Tell the new tab contents it is about to become the selected tab. Here it
     // can do things like make sure the toolbar is up to date.
 
-    AVTTabDocumentController* newController = [self.tabDocumentArray objectAtIndex: index];
+    AVTTabDocumentController* newController = [self documentControllerAtModelIndex: modelIndex];
     [newController willBecomeSelectedTab];
 
     // Relayout for new tabs and to let the selected tab grow to be larger in
-    // size than surrounding tabs if the user has many. This also raises the
-    // selected tab to the top.
+    // size than surrounding tabs if the user has many.
 
-    [self layoutTabs];
+    [self setNeedsTabLayout];
 
     // Swap in the contents for the new tab.
 
@@ -971,11 +1412,11 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
 
     NSInteger index = [self indexFromModelIndex: modelIndex];
 
-    AVTTabController* tab = [self.tabArray objectAtIndex: index];
+    AVTTabController* tab = [self slotAtIndex: index]->tabController;
     if( self.tabWellModel.count > 0 )
     {
         [self startClosingTabWithAnimation: tab];
-        [self layoutTabs];
+        [self setNeedsTabLayout];
     }
     else
     {
@@ -999,34 +1440,28 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
     NSInteger from = [self indexFromModelIndex: modelFrom];
     NSInteger to = [self indexFromModelIndex: modelTo];
 
-    AVTTabDocumentController* movedTabContentsController = [[self.tabDocumentArray objectAtIndex: from] retain];
-    {
-        [self.tabDocumentArray removeObjectAtIndex: from];
-        [self.tabDocumentArray insertObject: movedTabContentsController atIndex: to];
-        AVTTabController* movedTabController = [[self.tabArray objectAtIndex: from] retain];
-        {
-            NSAssert( [movedTabController isKindOfClass: [AVTTabController class]], @"Wrong kind of class." );
-            [self.tabArray removeObjectAtIndex: from];
-            [self.tabArray insertObject: movedTabController atIndex: to];
+    [self moveSlotFromIndex: from toIndex: to];
 
-            // The tab moved, which means that the mini-tab state may have changed.
+    AVTTabController* movedTabController = [self slotAtIndex: to]->tabController;
+    NSAssert( [movedTabController isKindOfClass: [AVTTabController class]], @"Wrong kind of class." );
 
-            if( [self.tabWellModel isMiniTabForIndex: modelTo] != [movedTabController mini] )
-                [self tabMiniStateChangedWithDocument: document atIndex: modelTo];
-        }
-        [movedTabController release];
-    }
-    [movedTabContentsController release];
+    // A moved tab has new neighbours, so it needs a new place in the z-order. Nobody else's relative order changed.
+
+    [self updateZOrderForTab: movedTabController];
+
+    // The tab moved, which means that the mini-tab state may have changed.
+
+    if( [self.tabWellModel isMiniTabForIndex: modelTo] != [movedTabController mini] )
+        [self tabMiniStateChangedWithDocument: document atIndex: modelTo];
 }
 
 #pragma mark - Utilities
 
-// Called by the CAAnimation delegate when the tab completes the closing animation.
+// Called by the animation timeline when the tab completes (or abandons) the closing animation.
 
 - (void) animationDidStopForController: (AVTTabController*) controller
                               finished: (BOOL) finished
 {
-    [self.closingControllers removeObject: controller];
     [self removeTab: controller];
 }
 
@@ -1034,36 +1469,36 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
 {
     NSAssert( [NSThread isMainThread], @"Must be called on main thread." );
 
-    // Save off the controller into the set of animating tabs. This alerts the layout method to not do anything with it and allows us
+    // Mark the tab's slot as animating closed. This alerts the layout method to not do anything with it and allows us
     // to correctly calculate offsets when working with indices into the model.
 
-    [self.closingControllers addObject: closingTab];
+    NSInteger slotIndex = [self slotIndexForTabController: closingTab];
+    NSAssert( slotIndex != kNoTab, @"Closing a tab that isn't in the well." );
+    AVTTabSlot* slot = [self slotAtIndex: slotIndex];
+    if( !slot->closing )
+    {
+        slot->closing = YES;
+        ++_closingSlotCount;
+    }
 
     // Mark the tab as closing. This prevents it from generating any drags or selections while it's animating closed.
 
     [(AVTTabView*)[closingTab view] setClosing: YES];
 
-    // Register delegate (owned by the animation system).
+    // Periscope down! Animate the tab, removing it once it's out of sight. The well isn't retained by the completion: it invalidates
+    // the timeline, dropping the completion, when it goes away.
 
     NSView* tabView = [closingTab view];
-    CAAnimation* animation = [[tabView animationForKey: @"frameOrigin"] copy];
-    [animation autorelease];
-    TabCloseAnimationDelegate* delegate = [[TabCloseAnimationDelegate alloc] initWithTabWell: self tabController: closingTab];
-    [animation setDelegate: delegate];
-    NSMutableDictionary* animationDictionary = [NSMutableDictionary dictionaryWithDictionary: [tabView animations]];
-    [animationDictionary setObject: animation forKey: @"frameOrigin"];
-    [tabView setAnimations: animationDictionary];
-    [delegate release];
-
-    // Periscope down! Animate the tab.
-
     NSRect newFrame = [tabView frame];
     newFrame = NSOffsetRect( newFrame, 0, -newFrame.size.height );
-    [NSAnimationContext beginGrouping];
-    [[NSAnimationContext currentContext] avt_setDuration: kAnimationDuration
-                                               eventMask: NSLeftMouseUpMask];
-    [[tabView animator] setFrame: newFrame];
-    [NSAnimationContext endGrouping];
+
+    __block AVTTabWellController* well = self;
+    [self.animationTimeline animateView: tabView
+                                toFrame: newFrame
+                               duration: [NSAnimationContext avt_duration: kAnimationDuration eventMask: NSLeftMouseUpMask]
+                             completion: ^( BOOL finished ) {
+                                 [well animationDidStopForController: closingTab finished: finished];
+                             }];
 }
 
 // Called when a tab is pinned or unpinned without moving.
@@ -1075,7 +1510,7 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
 
     NSInteger index = [self indexFromModelIndex: modelIndex];
 
-    AVTTabController* tabController = [self.tabArray objectAtIndex: index];
+    AVTTabController* tabController = [self slotAtIndex: index]->tabController;
     NSAssert( [tabController isKindOfClass: [AVTTabController class]], @"Not a tab controller" );
     [tabController setMini: [self.tabWellModel isMiniTabForIndex: modelIndex]];
     [tabController setPinned: [self.tabWellModel isTabPinnedForIndex: modelIndex]];
@@ -1085,44 +1520,45 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
     // If the tab is being restored and it's pinned, the mini state is set after the tab has already been rendered,
     // so re-layout the tabstrip. In all other cases, the state is set before the tab is rendered so this isn't needed.
 
-    [self layoutTabs];
+    [self setNeedsTabLayout];
 }
 
 // Remove all knowledge about this tab and its associated controller, and remove the view from the strip.
 
 - (void) removeTab: (AVTTabController*) controller
 {
-    NSUInteger index = [self.tabArray indexOfObject: controller];
+    NSInteger index = [self slotIndexForTabController: controller];
+    NSAssert( index != kNoTab, @"Removing a tab that isn't in the well." );
 
-    // Release the tab contents controller so those views get destroyed. This will remove all the tab content Cocoa views from the hierarchy.
-    // A subsequent "select tab" notification will follow from the model. To tell us what to swap in in its absence.
+    // Hold on to the controller while we tear it down; releasing its slot would otherwise free it.
 
-    [self.tabDocumentArray removeObjectAtIndex: index];
+    [[controller retain] autorelease];
 
     // Remove the view from the tab strip.
 
     NSView* tab = [controller view];
     [tab removeFromSuperview];
 
-    // Remove ourself as an observer.
+    // Stop any slide that was in flight. A closing tab only gets here from its own completed close animation, which is already gone.
 
-    [[NSNotificationCenter defaultCenter] removeObserver: self
-                                                    name: NSViewDidUpdateTrackingAreasNotification
-                                                  object: tab];
+    if( ![self slotAtIndex: index]->closing )
+        [self.animationTimeline cancelAnimationForView: tab];
 
     // Clear the tab controller's target.
 
     [controller setTarget: nil];
 
     if( [self.hoveredTab isEqual: tab] )
+    {
+        self.hoveredCloseButton = nil;
         self.hoveredTab = nil;
+    }
 
-    NSValue* identifier = [NSValue valueWithPointer: tab];
-    [self.targetFrames removeObjectForKey: identifier];
-
-    // Once we're totally done with the tab, delete its controller
+    // Once we're totally done with the tab, release its slot. This releases the tab contents controller so those views get
+    // destroyed, removing all the tab content Cocoa views from the hierarchy. A subsequent "select tab" notification will follow
+    // from the model to tell us what to swap in in its absence.
 
-    [self.tabArray removeObjectAtIndex: index];
+    [self removeSlotAtIndex: index];
 }
 
 // Given an index into the tab model, returns the index into the tab controller or tab document controller array accounting
@@ -1133,21 +1569,21 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
 {
     NSAssert( index >= 0, @"Invalid index." );
 
+    // Nothing is closing, so the indices line up. This is the steady-state.
+
+    if( _closingSlotCount == 0 || index < 0 )
+        return index;
+
     NSInteger resultIndex = index;
-    if( index >= 0 )
+    for( NSUInteger i = 0; i < _slotCount; ++i )
     {
-        NSInteger i = 0;
-        for( AVTTabController* controller in self.tabArray )
+        if( _slots[i].closing )
         {
-            if( [self.closingControllers containsObject: controller] )
-            {
-                NSAssert( [(AVTTabView*)controller.view isClosing], @"Although this index is in the closing controllers, it isn't marked as closing." );
-                ++index;
-            }
-            if( i == index ) // No need to check anything after, it has no effect.
-                break;
-            ++i;
+            NSAssert( [(AVTTabView*)_slots[i].tabController.view isClosing], @"Although this slot is closing, its view isn't marked as closing." );
+            ++resultIndex;
         }
+        if( i == resultIndex ) // No need to check anything after, it has no effect.
+            break;
     }
 
     return resultIndex;
@@ -1157,6 +1593,10 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
 
 - (void) moveTabFromIndex: (NSInteger) from
 {
+    // The placeholder index comes from the laid out geometry, so make sure it reflects the latest placeholder position.
+
+    [self layoutTabsIfNeeded];
+
     int toIndex = [self indexOfPlaceholder];
     [self.tabWellModel moveTabDocumentAtIndex: from toIndex: toIndex selectAfterMove: YES];
 }
@@ -1172,6 +1612,8 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
                withFrame: (NSRect) frame
              asPinnedTab: (BOOL) pinned;
 {
+    [self layoutTabsIfNeeded];
+
     NSInteger modelIndex = [self indexOfPlaceholder];
 
     // Mark that the new tab being created should start at |frame|. It will be
@@ -1189,39 +1631,13 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
 
 // Called when the tab strip view changes size. As we only registered for
 // changes on our view, we know it's only for our view. Layout w/out
-// animations since they are blocked by the resize nested runloop. We need
-// the views to adjust immediately. Neither the tabs nor their z-order are
-// changed, so we don't need to update the subviews.
+// animations since they are blocked by the resize nested runloop. The
+// request is merged with any others in this run loop turn. Neither the
+// tabs nor their z-order are changed, so we don't need to update the subviews.
 
 - (void) tabViewFrameChanged: (NSNotification*) info
 {
-    [self layoutTabsWithAnimation: NO regenerateSubviews: NO];
-}
-
-// Called when the tracking areas for any given tab are updated. This allows
-// the individual tabs to update their hover states correctly.
-// Only generates the event if the cursor is in the tab strip.
-
-- (void) tabUpdateTracking: (NSNotification*) notification
-{
-    NSAssert( [[notification object] isKindOfClass: [AVTTabView class]], @"Wrong class in notification." );
-    NSAssert( self.mouseInside, @"we should be mouseInside for this to be called." );
-
-    NSWindow* window = self.tabWellView.window;
-    NSPoint location = [window mouseLocationOutsideOfEventStream];
-    if( NSPointInRect( location, self.tabWellView.frame ) )
-    {
-        NSEvent* mouseEvent = [NSEvent mouseEventWithType: NSMouseMoved
-                                                 location: location
-                                            modifierFlags: 0
-                                                timestamp: 0
-                                             windowNumber: [window windowNumber]
-                                                  context: nil
-                                              eventNumber: 0
-                                               clickCount: 0
-                                                 pressure: 0];
-        [self mouseMoved: mouseEvent];
-    }
+    [self setNeedsTabLayoutWithAnimation: NO regenerateSubviews: NO];
 }
 
 // Returns the index of the subview |view|. Returns -1 if not present. Takes closing tabs into account such that this index
@@ -1230,13 +1646,13 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
 - (NSInteger) modelIndexForTabView: (NSView*) view
 {
     NSInteger index = 0;
-    for( AVTTabController* current in self.tabArray )
+    for( NSUInteger i = 0; i < _slotCount; ++i )
     {
-        // If |current| is closing, skip it.
+        // If the tab is closing, skip it.
 
-        if( [self.closingControllers containsObject: current] )
+        if( _slots[i].closing )
             continue;
-        else if( [current view] == view )
+        else if( [_slots[i].tabController view] == view )
             return index;
         ++index;
     }
@@ -1251,23 +1667,15 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
 - (NSInteger) modelIndexForDocumentView: (NSView*) view
 {
     NSInteger index = 0;
-    NSInteger i = 0;
-    for( AVTTabDocumentController* current in self.tabDocumentArray )
+    for( NSUInteger i = 0; i < _slotCount; ++i )
     {
-        // If the CTTabController corresponding to |current| is closing, skip it.
+        // If the tab is closing, skip it.
 
-        AVTTabController* controller = [self.tabArray objectAtIndex: i];
-        if( [self.closingControllers containsObject: controller] )
-        {
-            ++i;
+        if( _slots[i].closing )
             continue;
-        }
-        else if( [current view] == view )
-        {
+        else if( [_slots[i].documentController view] == view )
             return index;
-        }
         ++index;
-        ++i;
     }
 
     return -1;
@@ -1280,8 +1688,8 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
 {
     NSView* view = nil;
 
-    if( index > 0 && index < self.tabArray.count )
-        view = [[self.tabArray objectAtIndex: index] view];
+    if( index >= 0 && index < _slotCount )
+        view = [_slots[index].tabController view];
 
     return view;
 }
@@ -1293,10 +1701,73 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
                            frame: (NSRect) frame
                    yStretchiness: (CGFloat) yStretchiness;
 {
+    // Once a drag is under way the placeholder only slides along the strip, so skip the layout and move just the tabs it passes.
+    // The first event of a drag, and any event that arrives while something else has asked for a layout, takes the full path.
+
+    BOOL sameDrag = tab != nil && tab == self.placeholderTab && NSWidth( frame ) == NSWidth( self.placeholderFrame );
+
     self.placeholderTab = tab;
     self.placeholderFrame = frame;
     self.placeholderStretchiness = yStretchiness;
-    [self layoutTabsWithAnimation: self.initialLayoutComplete regenerateSubviews: NO];
+
+    if( sameDrag && _dragGapValid && !self.tabLayoutPending && self.forceAddTabButtonHidden )
+        [self movePlaceholderGap];
+    else
+        [self setNeedsTabLayout];
+}
+
+// The drag fast path. The placeholder tab is moved to the new placeholder frame and the gap the other tabs leave for it is
+// looked up by binary search. Only the tabs between the old and the new position of the gap are moved, each by the width of the
+// gap, which is exactly what a full layout would do: widths don't change during a drag (the new tab button is hidden throughout),
+// so a tab's position depends only on which side of the gap it is on.
+
+- (void) movePlaceholderGap
+{
+    [self rebuildOffsetIndexIfNeeded];
+
+    self.placeholderMoveCount++;
+
+    if( _dragPlaceholderSlot != kNoTab )
+    {
+        AVTTabSlot* slot = [self slotAtIndex: _dragPlaceholderSlot];
+        NSRect tabFrame = slot->currentFrame;
+        tabFrame.origin.x = NSMinX( self.placeholderFrame );
+        slot->targetFrame = tabFrame;
+        slot->hasTargetFrame = YES;
+        slot->currentFrame = tabFrame;
+        [self.animationTimeline setFrame: tabFrame ofView: [slot->tabController view]];
+    }
+
+    NSUInteger gapIndex = AVTIndexOfPlaceholderGap( _offsets, _offsetCount, NSMinX( self.placeholderFrame ), _dragGapIndex, _dragGapWidth );
+    if( gapIndex == _dragGapIndex )
+        return;
+
+    // Moving the gap left pushes the tabs it passes to the right, and the other way around. The offset index stays sorted.
+
+    const NSUInteger first = MIN( gapIndex, _dragGapIndex );
+    const NSUInteger last = MAX( gapIndex, _dragGapIndex );
+    const CGFloat shift = gapIndex < _dragGapIndex ? _dragGapWidth : -_dragGapWidth;
+    const BOOL visible = [[self.tabWellView window] isVisible];
+    const NSTimeInterval duration = [NSAnimationContext avt_duration: kAnimationDuration eventMask: NSLeftMouseDraggedMask];
+
+    for( NSUInteger i = first; i < last; ++i )
+    {
+        AVTTabOffset* offset = &_offsets[i];
+        offset->minX += shift;
+        offset->maxX += shift;
+
+        AVTTabSlot* slot = [self slotAtIndex: offset->slotIndex];
+        slot->currentFrame = NSOffsetRect( slot->currentFrame, shift, 0 );
+        slot->targetFrame = slot->currentFrame;
+        slot->hasTargetFrame = YES;
+
+        if( visible )
+            [self.animationTimeline animateView: [slot->tabController view] toFrame: slot->currentFrame duration: duration completion: nil];
+        else
+            [self.animationTimeline setFrame: slot->currentFrame ofView: [slot->tabController view]];
+    }
+
+    _dragGapIndex = gapIndex;
 }
 
 // Create a new tab view and set its cell correctly so it draws the way we want it to. It will be sized and positioned by
@@ -1332,6 +1803,7 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
     NSAssert( [sender isKindOfClass: [AVTTabView class]], @"Sender is wrong class." );
     if( [self.hoveredTab isEqual: sender] )
     {
+        self.hoveredCloseButton = nil;
         self.hoveredTab = nil;
     }
 
@@ -1341,6 +1813,11 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
         const NSInteger numberOfOpenTabs = [self numberOfOpenTabs];
         if( numberOfOpenTabs > 1 )
         {
+            // Make sure the frames we base the width on are the ones from the latest layout. Tabs closed before this one may still be
+            // animating closed, so go through the slots (using the laid out rather than the animating frames) instead of the views.
+
+            [self layoutTabsIfNeeded];
+
             bool isClosingLastTab = index == numberOfOpenTabs - 1;
             if( !isClosingLastTab )
             {
@@ -1349,8 +1826,8 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
                 // TODO(pinkerton): re-visit when handling tab overflow.
                 // http://crbug.com/188
 
-                NSView* penultimateTab = [self viewAtIndex: numberOfOpenTabs - 2];
-                self.availableResizeWidth = NSMaxX( [penultimateTab frame] );
+                NSInteger penultimateIndex = [self indexFromModelIndex: numberOfOpenTabs - 2];
+                self.availableResizeWidth = NSMaxX( [self slotAtIndex: penultimateIndex]->currentFrame );
             }
             else
             {
@@ -1358,9 +1835,15 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
                 // another tab's close button lands below the cursor (assuming the tabs
                 // are currently below their maximum width and can grow).
 
-                NSView* lastTab = [self viewAtIndex: numberOfOpenTabs - 1];
-                self.availableResizeWidth = NSMaxX( lastTab.frame );
+                NSInteger lastIndex = [self indexFromModelIndex: numberOfOpenTabs - 1];
+                self.availableResizeWidth = NSMaxX( [self slotAtIndex: lastIndex]->currentFrame );
             }
+
+            // Reflow once the user stops closing tabs, even if the mouse never leaves the well. Every close pushes this out.
+
+            [NSObject cancelPreviousPerformRequestsWithTarget: self selector: @selector( endRapidClosureMode ) object: nil];
+            [self performSelector: @selector( endRapidClosureMode ) withObject: nil afterDelay: kRapidClosureTimeout];
+
             [self.tabWellModel closeTabDocumentAtIndex: index];
         }
         else
@@ -1405,20 +1888,18 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
         // Take closing tabs into account.
 
         NSInteger index = [self indexFromModelIndex: modelIndex];
-        AVTTabController* tabController = [self.tabArray objectAtIndex: index];
+        AVTTabController* tabController = [self slotAtIndex: index]->tabController;
 
         // Since the tab is loading, it cannot be phantom any more.
 
-        bool oldHasIcon = [tabController iconView] != nil;
-        bool newHasIcon = [document hasIcon] || [self.tabWellModel isMiniTabForIndex: modelIndex]; // Always show icon if mini.
+        BOOL newHasIcon = [document hasIcon] || [self.tabWellModel isMiniTabForIndex: modelIndex]; // Always show icon if mini.
 
-        AVTTabLoadingState oldState = [tabController loadingState];
         AVTTabLoadingState newState = eTabLoadingStateDone;
         NSImage* throbberImage = nil;
         if( [document isCrashed] )
         {
             newState = eTabLoadingStateCrashed;
-            newHasIcon = true;
+            newHasIcon = YES;
         }
         else if( [document isWaitingForResponse] )
         {
@@ -1431,40 +1912,28 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
             throbberImage = sThrobberLoadingImage;
         }
 
-        if( oldState != newState )
+        if( [tabController loadingState] != newState )
             [tabController setLoadingState: newState];
 
-        // While loading, this function is called repeatedly with the same state.
-        // To avoid expensive unnecessary view manipulation, only make changes when
-        // the state is actually changing.  When loading is complete
-        // (CTTabLoadingStateDone), every call to this function is significant.
+        // While loading, this function is called repeatedly with the same state. The tab's icon view ignores requests to show
+        // what it already shows, so an update that changes nothing doesn't touch any views.
 
-        if( newState == eTabLoadingStateDone || oldState != newState || oldHasIcon != newHasIcon )
+        AVTTabIconView* iconView = tabController.tabIconView;
+        if( newHasIcon )
         {
-            NSView* iconView = nil;
-            if( newHasIcon )
-            {
-                if( newState == eTabLoadingStateDone )
-                {
-                    iconView = [self iconImageViewForDocument: document];
-                }
-                else if( newState == eTabLoadingStateCrashed )
-                {
-                    NSImage* oldImage = [[self iconImageViewForDocument: document] image];
-                    NSRect frame = NSMakeRect( 0, 0, kIconWidthAndHeight, kIconWidthAndHeight );
-                    iconView = [AVTThrobberView toastThrobberViewWithFrame: frame
-                                                               beforeImage: oldImage
-                                                                afterImage: sSadIconImage];
-                }
-                else
-                {
-                    NSRect frame = NSMakeRect( 0, 0, kIconWidthAndHeight, kIconWidthAndHeight );
-                    iconView = [AVTThrobberView filmstripThrobberViewWithFrame: frame
-                                                                         image: throbberImage];
-                }
-            }
+            if( newState == eTabLoadingStateDone )
+                [iconView showIconForImage: [self iconImageForDocument: document]];
+            else if( newState == eTabLoadingStateCrashed )
+                [iconView showCrashedFromImage: [self iconImageForDocument: document] toImage: sSadIconImage];
+            else
+                [iconView showThrobberWithImage: throbberImage];
 
-            [tabController setIconView: iconView];
+            if( tabController.iconView != iconView )
+                [tabController setIconView: iconView];
+        }
+        else if( tabController.iconView )
+        {
+            [tabController setIconView: nil];
         }
     }
 }
@@ -1482,16 +1951,18 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
     [tab setTitle: titleString];
 }
 
-// A helper routine for creating an NSImageView to hold the fav icon or app icon for |contents|.
-
-- (NSImageView*) iconImageViewForDocument: (AVTTabDocument*) document
+- (void) updateLoadingStateForDocument: (AVTTabDocument*) document
 {
-    NSImage* image = document.icon ? document.icon : [[self.defaultIcon copy] autorelease];
-    NSRect frame = NSMakeRect( 0.0f, 0.0f, kIconWidthAndHeight, kIconWidthAndHeight );
-    NSImageView* view = [[[NSImageView alloc] initWithFrame: frame] autorelease];
-    [view setImage: image];
+    NSInteger modelIndex = [self.tabWellModel indexOfTabDocument: document];
+    if( modelIndex != kNoTab )
+        [self updateIconRepresentationForDocument: document atIndex: modelIndex];
+}
 
-    return view;
+// The image to show as the icon for |document|.
+
+- (NSImage*) iconImageForDocument: (AVTTabDocument*) document
+{
+    return document.icon ? document.icon : self.defaultIcon;
 }
 
 // Finds the AVTTabdocumentController associated with the given index into the tab model and swaps out the sole child
@@ -1501,8 +1972,7 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
 {
     NSAssert( modelIndex >= 0 && modelIndex < self.tabWellModel.count, @"Invalid index." );
 
-    NSInteger index = [self indexFromModelIndex: modelIndex];
-    AVTTabDocumentController* controller = [self.tabDocumentArray objectAtIndex: index];
+    AVTTabDocumentController* controller = [self documentControllerAtModelIndex: modelIndex];
 
     // Resize the new view to fit the window. Calling |view| may lazily instantiate the AVTTabDocumentController from the nib.
     // Until we call|-ensureContentsVisible|, the controller doesn't install the RWHVMac into the view hierarchy. This is in
@@ -1619,34 +2089,46 @@ static NSString* const kTabWellNumberOfTabsChanged = @"kTabWellNumberOfTabsChang
 
 @end
 
-#pragma mark - Animation Delegate
+// Returns the index of the first entry of |offsets| that the placeholder gap should open before when the placeholder is at |x|:
+// the first tab whose center would be to the right of |x| with the strip closed up. The entries currently open a gap of
+// |gapWidth| before |gapIndex|, which is taken out again. Returns |count| if the gap belongs at the end.
 
-@implementation TabCloseAnimationDelegate
-
-- (id) initWithTabWell: (AVTTabWellController*) well
-         tabController: (AVTTabController*) controller
+NSUInteger AVTIndexOfPlaceholderGap( const AVTTabOffset* offsets, NSUInteger count, CGFloat x, NSUInteger gapIndex, CGFloat gapWidth )
 {
-    self = [super init];
-    if( self != nil )
+    NSUInteger low = 0;
+    NSUInteger high = count;
+    while( low < high )
     {
-        NSAssert( well && controller, @"well and controller MUST be supplied" );
+        NSUInteger middle = low + (high - low) / 2;
+        CGFloat midX = (offsets[middle].minX + offsets[middle].maxX) / 2;
+        if( middle >= gapIndex )
+            midX -= gapWidth;
 
-        _well = well;
-        _controller = controller;
+        if( midX > x )
+            high = middle;
+        else
+            low = middle + 1;
     }
 
-    return self;
+    return low;
 }
 
-- (void) invalidate
-{
-    _well = nil;
-    _controller = nil;
-}
+// Returns the number of leading entries of |offsets| (which are sorted by |minX|) that start to the left of |x|, or at |x| as well
+// when |inclusive| is set.
 
-- (void) animationDidStop: (CAAnimation*) animation finished: (BOOL) finished
+NSUInteger AVTCountOfOffsetsBefore( const AVTTabOffset* offsets, NSUInteger count, CGFloat x, BOOL inclusive )
 {
-    [self.well animationDidStopForController: self.controller finished: finished];
-}
+    NSUInteger low = 0;
+    NSUInteger high = count;
+    while( low < high )
+    {
+        NSUInteger middle = low + (high - low) / 2;
+        BOOL before = inclusive ? offsets[middle].minX <= x : offsets[middle].minX < x;
+        if( before )
+            low = middle + 1;
+        else
+            high = middle;
+    }
 
-@end
+    return low;
+}
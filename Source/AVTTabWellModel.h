@@ -62,9 +62,12 @@ static const NSInteger kNoTab = -1;
 
 #pragma mark - Notifications
 
+// Model notifications are posted with the TabWellModel as the object, so observers can listen to one model.
+
 // Keys for data in the userInfo dictionary
 
 extern NSString* const kTabDocumentKey;
+extern NSString* const kTabDocumentsKey;
 extern NSString* const kOldTabDocumentKey;
 extern NSString* const kNewTabDocumentKey;
 extern NSString* const kTabDocumentIndexKey;
@@ -76,6 +79,12 @@ extern NSString* const kTabDocumentInForegroundKey;
 
 extern NSString* const kDidInsertTabDocumentNotification;       // TabDocument, index inForeground
 
+// A run of AVTTabDocuments was inserted into the TabWellModel in one go, the first at the specified index and the rest after it
+// in order. Posted by |-insertTabDocuments:atIndex:selecting:| in place of one kDidInsertTabDocumentNotification per document;
+// the documents are never inserted in the foreground, any selection follows as a separate notification.
+
+extern NSString* const kDidInsertTabDocumentsNotification;      // TabDocuments, index
+
 // The specified AVTTabDocument at |index| is being closed (and eventually destroyed).
 
 extern NSString* const kWillCloseTabDocumentNotification;       // TabDocument, Index
@@ -153,6 +162,13 @@ extern NSString* const kTabWellModelWillBeDeleted;
 
 - (void) insertTabDocument: (AVTTabDocument*) document atIndex: (NSInteger) index withFlags: (NSUInteger) flags;
 
+// Inserts |documents| as one run at |index|, or where the order controller appends if |index| is out of range, with a single
+// kDidInsertTabDocumentsNotification. If |select| is YES the first of them is selected afterwards, with a single selection change.
+// App documents are pinned and go into the mini-tab area one at a time. Returns the index of the first document of the run, or
+// kNoTab if there was none.
+
+- (NSInteger) insertTabDocuments: (NSArray*) documents atIndex: (NSInteger) index selecting: (BOOL) select;
+
 // Adds the specified AVTTabDocument in the default location. Tabs opened in the foreground inherit the group of the previously selected tab.
 
 - (void) appendTabDocument: (AVTTabDocument*) document inForeground: (BOOL) foreground;
@@ -242,7 +242,7 @@
     // This is listened to by (at least) the ContainerWindowController and the TabWellController, in that order.
 
     NSDictionary* userinfo = @{ kTabDocumentKey : document, kTabDocumentIndexKey : @(index), kTabDocumentInForegroundKey : [NSNumber numberWithBool: foreground] };
-    [[NSNotificationCenter defaultCenter] postNotificationName: kDidInsertTabDocumentNotification object: nil userInfo: userinfo];
+    [[NSNotificationCenter defaultCenter] postNotificationName: kDidInsertTabDocumentNotification object: self userInfo: userinfo];
     
     if( foreground )
         [self changeSelectedDocumentFrom: selectedDocument toIndex: index];
@@ -250,6 +250,68 @@
     [self dumpModelFromMethod: NSStringFromSelector( _cmd )];
 }
 
+// Inserts |documents| as one run with a single notification and at most one selection change, so opening hundreds of documents
+// doesn't cost hundreds of rounds of observer work. See the header.
+
+- (NSInteger) insertTabDocuments: (NSArray*) documents
+                         atIndex: (NSInteger) index
+                       selecting: (BOOL) select
+{
+    AVTTabDocument* selectedDocument = [self selectedTabDocument];
+
+    // App tabs are forced to be pinned, and pinned tabs live in their own area at the front, so they can't join the run. |index|
+    // refers to the tabs as they were before the call, so each app tab inserted at or before it moves it along by one.
+
+    NSMutableArray* run = [NSMutableArray arrayWithCapacity: documents.count];
+    for( AVTTabDocument* document in documents )
+    {
+        if( document.isApp )
+        {
+            NSInteger appIndex = self.indexOfFirstNonMiniTab;
+            [self insertTabDocument: document atIndex: appIndex withFlags: eAddPinned];
+            if( index >= appIndex )
+                index++;
+        }
+        else
+        {
+            [run addObject: document];
+        }
+    }
+
+    NSInteger runIndex = kNoTab;
+    if( run.count )
+    {
+        if( index < 0 || index > self.count )
+            index = [self.orderController determineInsertionIndexForAppending];
+        runIndex = [self constrainInsertionIndex: index withMiniTab: NO];
+
+        // See |-insertTabDocument:atIndex:withFlags:|.
+
+        self.closingAll = false;
+        if( select && selectedDocument )
+            [self forgetAllOpeners];
+
+        NSMutableArray* data = [NSMutableArray arrayWithCapacity: run.count];
+        for( AVTTabDocument* document in run )
+            [data addObject: [NSMutableDictionary dictionaryWithObjectsAndKeys: document, @"document", [NSNumber numberWithBool: NO], @"pinned", nil]];
+
+        [self.documentData insertObjects: data atIndexes: [NSIndexSet indexSetWithIndexesInRange: NSMakeRange( runIndex, run.count )]];
+
+        if( runIndex <= self.selectedIndex )
+            self.selectedIndex += run.count;
+
+        NSDictionary* userinfo = @{ kTabDocumentsKey : run, kTabDocumentIndexKey : @(runIndex) };
+        [[NSNotificationCenter defaultCenter] postNotificationName: kDidInsertTabDocumentsNotification object: self userInfo: userinfo];
+    }
+
+    if( select && documents.count )
+        [self changeSelectedDocumentFrom: selectedDocument toIndex: [self indexOfTabDocument: documents[0]]];
+
+    [self dumpModelFromMethod: NSStringFromSelector( _cmd )];
+
+    return runIndex;
+}
+
 // Closes the AVTTabDocument at the specified index. This causes the AVTTabDocument to be destroyed, but it may not happen immediately
 // (e.g. if it's a AVTTabDocument). Returns true if the AVTTabDocument was closed immediately, false if it was not
 // closed (we may be waiting for a response from an onunload handler, or waiting for the user to confirm closure).
@@ -301,7 +363,7 @@
     [self.documentData replaceObjectAtIndex: index withObject: documentDictionary];
 
     NSDictionary* userinfo = @{ kOldTabDocumentKey : oldDocument, kNewTabDocumentKey : newDocument };
-    [[NSNotificationCenter defaultCenter] postNotificationName: kTabDocumentDidGetReplacedNotification object: nil userInfo: userinfo];
+    [[NSNotificationCenter defaultCenter] postNotificationName: kTabDocumentDidGetReplacedNotification object: self userInfo: userinfo];
 
     [oldDocument destroy: self];
 
@@ -326,7 +388,7 @@
             self.closingAll = YES;
 
         NSDictionary* userinfo = @{ kTabDocumentKey : removedDocument, kTabDocumentIndexKey : @(index) };
-        [[NSNotificationCenter defaultCenter] postNotificationName: kDidDetachTabDocumentNotification object: nil userInfo: userinfo];
+        [[NSNotificationCenter defaultCenter] postNotificationName: kDidDetachTabDocumentNotification object: self userInfo: userinfo];
 
         if( self.count )
         {
@@ -404,7 +466,7 @@
         if( lastSelectedDocument )
         {
             NSDictionary* userinfo = @{ kTabDocumentKey : lastSelectedDocument, kTabDocumentIndexKey : @(self.selectedIndex) };
-            [[NSNotificationCenter defaultCenter] postNotificationName: kDidDeselectTabDocumentNotification object: nil userInfo: userinfo];
+            [[NSNotificationCenter defaultCenter] postNotificationName: kDidDeselectTabDocumentNotification object: self userInfo: userinfo];
         }
 
         self.selectedIndex = toIndex;
@@ -415,7 +477,7 @@
         else
             userinfo = @{ kNewTabDocumentKey : newDocument, kTabDocumentIndexKey : @(self.selectedIndex) };
 
-        [[NSNotificationCenter defaultCenter] postNotificationName: kDidSelectTabDocumentNotification object: nil userInfo: userinfo];
+        [[NSNotificationCenter defaultCenter] postNotificationName: kDidSelectTabDocumentNotification object: self userInfo: userinfo];
     }
 }
 
@@ -651,7 +713,7 @@
     }
 
     NSDictionary* userinfo = @{ kTabDocumentKey : [self tabDocumentAtIndex: index], kTabDocumentIndexKey : @(index), kTabDocumentToIndexKey : @(toPosition) };
-    [[NSNotificationCenter defaultCenter] postNotificationName: kTabDocumentDidMoveNotification object: nil userInfo: userinfo];
+    [[NSNotificationCenter defaultCenter] postNotificationName: kTabDocumentDidMoveNotification object: self userInfo: userinfo];
 }
 
 @end
@@ -661,6 +723,7 @@
 // Keys for data in the userInfo dictionary
 
 NSString* const kTabDocumentKey = @"kTabDocumentKey";
+NSString* const kTabDocumentsKey = @"kTabDocumentsKey";
 NSString* const kOldTabDocumentKey = @"kOldTabDocumentKey";
 NSString* const kNewTabDocumentKey = @"kNewTabDocumentKey";
 NSString* const kTabDocumentIndexKey = @"kTabDocumentIndexKey";
@@ -668,6 +731,7 @@ NSString* const kTabDocumentToIndexKey = @"kTabDocumentToIndexKey";
 NSString* const kTabDocumentInForegroundKey = @"kTabDocumentInForegroundKey";
 
 NSString* const kDidInsertTabDocumentNotification = @"kDidInsertTabDocumentNotification";
+NSString* const kDidInsertTabDocumentsNotification = @"kDidInsertTabDocumentsNotification";
 NSString* const kWillCloseTabDocumentNotification = @"kWillCloseTabDocumentNotification";
 NSString* const kDidDetachTabDocumentNotification = @"kDidDetachTabDocumentNotification";
 NSString* const kDidDeselectTabDocumentNotification = @"kDidDeselectTabDocumentNotification";
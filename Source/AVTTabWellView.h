@@ -9,9 +9,23 @@
 #import <Foundation/Foundation.h>
 
 @class AVTNewTabButton;
+@class AVTTabView;
 
 @interface AVTTabWellView : NSView
 
+// When on, every tab well draws the backgrounds, glows and borders of its tabs in its own |-drawRect:|, and those tab views draw
+// nothing themselves; they remain for events, accessibility and their title, icon and close button subviews. A tab that would
+// end up behind the subviews of a tab beneath it, as while dragging, still draws itself; see |-drawsTabView:|. Off by default.
+// Changing it redraws every window.
+
++ (BOOL) drawsTabsInStrip;
++ (void) setDrawsTabsInStrip: (BOOL) drawsTabsInStrip;
+
+// YES if |tabView| is drawn in this view's tab pass rather than by itself. Worked out at the start of each pass, so it holds
+// for the tab views drawn in the same pass.
+
+- (BOOL) drawsTabView: (AVTTabView*) tabView;
+
 @property (nonatomic, assign) NSTimeInterval lastMouseUp;
 @property (nonatomic, retain) IBOutlet AVTNewTabButton* addTabButton;
 @property (nonatomic, assign) BOOL dropArrowShown;
@@ -9,9 +9,21 @@
 #import "AVTTabWellView.h"
 
 #import "AVTNewTabButton.h"
+#import "AVTTabView.h"
+
+static BOOL sDrawsTabsInStrip = NO;
 
 static BOOL ShouldWindowsMiniaturizeOnDoubleClick();
 
+@interface AVTTabWellView()
+
+- (void) drawTabsInRect: (NSRect) rect;
+- (void) updateTabsDrawingThemselves;
+
+@property (nonatomic, retain) NSHashTable* tabsDrawingThemselves;   // Not retained, rebuilt by every tab pass.
+
+@end
+
 @implementation AVTTabWellView
 
 - (id) initWithFrame: (NSRect) frame
@@ -25,6 +37,7 @@ static BOOL ShouldWindowsMiniaturizeOnDoubleClick();
         _bezelColor = [[NSColor colorWithCalibratedWhite: 247.0f / 255.0f alpha: 1.0f] retain];
         _arrowStrokeColor = [[NSColor colorWithCalibratedWhite: 0.0f alpha: 0.67f] retain];
         _arrowFillColor = [[NSColor colorWithCalibratedWhite: 1.0f alpha: 0.67f] retain];
+        _tabsDrawingThemselves = [[NSHashTable alloc] initWithOptions: NSPointerFunctionsOpaqueMemory | NSPointerFunctionsObjectPointerPersonality capacity: 0];
     }
 
     return self;
@@ -36,6 +49,7 @@ static BOOL ShouldWindowsMiniaturizeOnDoubleClick();
     [_bezelColor release];
     [_arrowStrokeColor release];
     [_arrowFillColor release];
+    [_tabsDrawingThemselves release];
 
     [super dealloc];
 }
@@ -110,6 +124,121 @@ static BOOL ShouldWindowsMiniaturizeOnDoubleClick();
         [self.arrowFillColor setFill];
         [arrow fill];
     }
+
+    if( sDrawsTabsInStrip )
+        [self drawTabsInRect: rect];
+}
+
+// Draws every tab that intersects |rect| in this view's own pass, back to front in the order the tab views would have drawn
+// themselves, so the tabs cost one view's worth of focusing and clipping rather than one each.
+
+- (void) drawTabsInRect: (NSRect) rect
+{
+    // The tab views draw right after this, so this is where it is decided which of them draw themselves this time.
+
+    [self updateTabsDrawingThemselves];
+
+    NSGraphicsContext* context = [NSGraphicsContext currentContext];
+    for( NSView* view in self.subviews )
+    {
+        if( ![view isKindOfClass: [AVTTabView class]] )
+            continue;
+
+        AVTTabView* tabView = (AVTTabView*)view;
+        NSRect tabFrame = tabView.frame;
+        if( !tabView.drawnByTabWell || tabView.isHidden || !NSIntersectsRect( tabFrame, rect ) )
+            continue;
+
+        [context saveGraphicsState];
+        NSRectClip( tabFrame );
+        NSAffineTransform* transform = [NSAffineTransform transform];
+        [transform translateXBy: NSMinX( tabFrame ) - NSMinX( tabView.bounds ) yBy: NSMinY( tabFrame ) - NSMinY( tabView.bounds )];
+        [transform concat];
+        [tabView drawTab];
+        [context restoreGraphicsState];
+    }
+}
+
+// A tab's title, icon and close button are subviews, drawn after this view's whole pass, so they would show through any tab
+// above it that was drawn in the pass. A tab whose shape covers the subviews of a tab beneath it draws itself instead, after
+// them. So does a tab that covers a tab beneath it that draws itself, which would otherwise be drawn over it. Laid out, tabs
+// only cover the edges of their neighbours and at most the selected tab draws itself; otherwise it is the tabs being dragged
+// or animating over others.
+
+- (void) updateTabsDrawingThemselves
+{
+    [self.tabsDrawingThemselves removeAllObjects];
+
+    NSArray* subviews = self.subviews;
+    NSRect* contentRects = malloc( subviews.count * sizeof( NSRect ) );
+    NSRect* selfDrawnFrames = malloc( subviews.count * sizeof( NSRect ) );
+    NSUInteger contentCount = 0;
+    NSUInteger selfDrawnCount = 0;
+
+    for( NSView* view in subviews )
+    {
+        if( ![view isKindOfClass: [AVTTabView class]] || view.isHidden )
+            continue;
+
+        AVTTabView* tabView = (AVTTabView*)view;
+        NSRect tabFrame = tabView.frame;
+
+        BOOL drawsItself = tabView.layer != nil;
+        for( NSUInteger i = 0; i < contentCount && !drawsItself; i++ )
+            drawsItself = NSIntersectsRect( tabFrame, contentRects[i] ) && [tabView shapeIntersectsRect: [tabView convertRect: contentRects[i] fromView: self]];
+
+        for( NSUInteger i = 0; i < selfDrawnCount && !drawsItself; i++ )
+            drawsItself = NSIntersectsRect( tabFrame, selfDrawnFrames[i] ) && [tabView shapeIntersectsRect: [tabView convertRect: selfDrawnFrames[i] fromView: self]];
+
+        if( drawsItself )
+        {
+            [self.tabsDrawingThemselves addObject: tabView];
+            selfDrawnFrames[selfDrawnCount++] = tabFrame;
+        }
+
+        NSRect contentRect = NSZeroRect;
+        for( NSView* subview in tabView.subviews )
+        {
+            if( !subview.isHidden )
+                contentRect = NSUnionRect( contentRect, [self convertRect: subview.frame fromView: tabView] );
+        }
+
+        if( !NSIsEmptyRect( contentRect ) )
+            contentRects[contentCount++] = NSIntersectionRect( contentRect, tabFrame );
+    }
+
+    free( contentRects );
+    free( selfDrawnFrames );
+}
+
+- (BOOL) drawsTabView: (AVTTabView*) tabView
+{
+    return sDrawsTabsInStrip && ![self.tabsDrawingThemselves containsObject: tabView];
+}
+
+- (void) willRemoveSubview: (NSView*) subview
+{
+    [self.tabsDrawingThemselves removeObject: subview];
+
+    [super willRemoveSubview: subview];
+}
+
++ (BOOL) drawsTabsInStrip
+{
+    return sDrawsTabsInStrip;
+}
+
++ (void) setDrawsTabsInStrip: (BOOL) drawsTabsInStrip
+{
+    if( drawsTabsInStrip != sDrawsTabsInStrip )
+    {
+        sDrawsTabsInStrip = drawsTabsInStrip;
+
+        // Tab views don't know to draw themselves again until they are next invalidated, so redraw every window.
+
+        for( NSWindow* window in [NSApp windows] )
+            [[window contentView] setNeedsDisplay: YES];
+    }
 }
 
 // Draw bottom border (a dark border and light highlight). Each tab is responsible for mimicking this bottom border, unless it's the selected tab.
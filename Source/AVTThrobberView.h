@@ -4,6 +4,8 @@
 
 #import <Cocoa/Cocoa.h>
 
+@class AVTFrameClock;
+@class AVTThrobberTimer;
 @protocol AVTThrobberDataDelegate;
 
 // A class that knows how to draw an animated state to indicate progress.
@@ -27,6 +29,73 @@
 
 + (id) toastThrobberViewWithFrame: (NSRect) frame beforeImage: (NSImage*) beforeImage afterImage: (NSImage*) afterImage;
 
+// Switch an existing view to a filmstrip of |image|, or a toast between the specified images, restarting the animation.
+
+- (void) setFilmstripImage: (NSImage*) image;
+- (void) setToastBeforeImage: (NSImage*) beforeImage afterImage: (NSImage*) afterImage;
+
+// Move the animation to where it should be at |time|, redrawing if the frame changed. Called by the throbber timer.
+
+- (void) animateToTime: (NSTimeInterval) time;
+
 @property (nonatomic, retain) id<AVTThrobberDataDelegate> dataDelegate;
 
+// The timer driving this view. Defaults to the shared timer.
+
+@property (nonatomic, retain) AVTThrobberTimer* throbberTimer;
+
+// YES if the view is in a window that can currently be seen: not hidden, miniaturized, occluded or in a hidden application.
+
+@property (nonatomic, readonly, getter=isOnScreen) BOOL onScreen;
+
+@end
+
+// The throbber timer animates any number of throbber views from one frame clock. Animation frames are derived from the clock's
+// time rather than counted, so every filmstrip in the application shows the same frame at the same moment whatever rate the
+// clock ticks at, and a throbber only redraws when its frame actually changes.
+//
+// Only throbbers that can be seen are advanced. When none of the registered throbbers can be seen the timer leaves the clock
+// altogether, and comes back when a window or the application is brought back into view.
+
+@interface AVTThrobberTimer : NSObject
+
+// Returns the timer shared by every throbber, driven by the shared frame clock.
+
++ (AVTThrobberTimer*) sharedThrobberTimer;
+
+// |clock| may be a manually ticked clock for driving the animation headlessly.
+
+- (id) initWithFrameClock: (AVTFrameClock*) clock;
+
+// Adds or removes a throbber. Throbbers are not retained and must remove themselves before they go away.
+
+- (void) addThrobber: (AVTThrobberView*) throbber;
+- (void) removeThrobber: (AVTThrobberView*) throbber;
+
+// Rejoin the clock if any throbber might be animating again. Called when a window or the application comes back into view.
+
+- (void) wake;
+
+// Stop listening to the clock and the window notifications.
+
+- (void) invalidate;
+
+@property (nonatomic, readonly) AVTFrameClock* clock;
+
+// Seconds between animation frames. Defaults to 30ms.
+
+@property (nonatomic, assign) NSTimeInterval frameInterval;
+
+// Number of throbbers registered, visible or not.
+
+@property (nonatomic, readonly) NSUInteger throbberCount;
+
+// YES while the timer is listening to the clock.
+
+@property (nonatomic, readonly, getter=isRunning) BOOL running;
+
+// Seconds spent advancing the throbbers on the last tick, not counting the drawing that follows.
+
+@property (nonatomic, readonly) NSTimeInterval lastTickDuration;
+
 @end
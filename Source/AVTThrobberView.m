@@ -4,13 +4,34 @@
 
 #import "AVTThrobberView.h"
 
-static const CGFloat kAnimationIntervalSeconds = 0.03;  // 30ms, same as windows
+#import "AVTFrameClock.h"
+
+#import <QuartzCore/QuartzCore.h>
+
+static const NSTimeInterval kAnimationIntervalSeconds = 0.03;  // 30ms, same as windows
+
+// The frames of a filmstrip image cut into separate bitmaps at one backing scale. Drawing a frame is a single blit of a bitmap
+// the size of the view instead of drawing a clipped section of the whole strip. Atlases are shared by every throbber in the
+// process and kept for its life; there are only ever a couple of filmstrip images.
+
+@interface AVTFilmstripAtlas : NSObject
+{
+    CGImageRef* _frames;
+}
+
++ (AVTFilmstripAtlas*) atlasForImage: (NSImage*) image scale: (CGFloat) scale;
+
+- (id) initWithImage: (NSImage*) image scale: (CGFloat) scale;
+- (void) drawFrame: (NSUInteger) frame inRect: (NSRect) rect;
+
+@property (nonatomic, assign) NSUInteger frameCount;
+
+@end
 
 @interface AVTThrobberView()
 
 - (id) initWithFrame: (NSRect) frame delegate: (id<AVTThrobberDataDelegate>) delegate;
 - (void) maintainTimer;
-- (void) animate;
 
 @end
 
@@ -20,13 +41,13 @@ static const CGFloat kAnimationIntervalSeconds = 0.03;  // 30ms, same as windows
 
 - (BOOL) animationIsComplete;
 
-// Draw the current frame into the current graphics context.
+// Draw the current frame into the current graphics context, which has a backing scale of |scale|.
 
-- (void) drawFrameInRect: (NSRect) rect;
+- (void) drawFrameInRect: (NSRect) rect scale: (CGFloat) scale;
 
-// Update the frame counter.
+// Move to the frame for |time|, with frames |frameInterval| seconds apart. Returns YES if the frame changed.
 
-- (void) advanceFrame;
+- (BOOL) advanceToTime: (NSTimeInterval) time frameInterval: (NSTimeInterval) frameInterval;
 
 @end
 
@@ -83,19 +104,22 @@ static const CGFloat kAnimationIntervalSeconds = 0.03;  // 30ms, same as windows
 }
 
 - (void) drawFrameInRect: (NSRect) rect
+                   scale: (CGFloat) scale
 {
-    CGFloat imageDimension = [_image size].height;
-    CGFloat xOffset = _animationFrame * imageDimension;
-    NSRect sourceImageRect = NSMakeRect( xOffset, 0, imageDimension, imageDimension );
-    [_image drawInRect: rect
-              fromRect: sourceImageRect
-             operation: NSCompositeSourceOver
-              fraction: 1.0];
+    [[AVTFilmstripAtlas atlasForImage: _image scale: scale] drawFrame: _animationFrame inRect: rect];
 }
 
-- (void) advanceFrame
+// Frames are counted from a fixed epoch rather than from when this throbber started, so all the filmstrips are in step.
+
+- (BOOL) advanceToTime: (NSTimeInterval) time
+         frameInterval: (NSTimeInterval) frameInterval
 {
-    _animationFrame = ++_animationFrame % _numFrames;
+    NSUInteger frame = (NSUInteger)floor( time / frameInterval ) % _numFrames;
+    if( frame == _animationFrame )
+        return NO;
+
+    _animationFrame = frame;
+    return YES;
 }
 
 @end
@@ -109,6 +133,7 @@ static const CGFloat kAnimationIntervalSeconds = 0.03;  // 30ms, same as windows
 @property (nonatomic, assign) NSSize image1Size;
 @property (nonatomic, assign) NSSize image2Size;
 @property (nonatomic, assign) NSInteger animationFrame;  // Current frame of the animation,
+@property (nonatomic, assign) NSTimeInterval startTime; // Time of the first frame, negative until the first advance.
 
 @end
 
@@ -124,6 +149,7 @@ static const CGFloat kAnimationIntervalSeconds = 0.03;  // 30ms, same as windows
         _image1Size = [image1 size];
         _image2Size = [image2 size];
         _animationFrame = 0;
+        _startTime = -1;
     }
 
     return self;
@@ -146,6 +172,7 @@ static const CGFloat kAnimationIntervalSeconds = 0.03;  // 30ms, same as windows
 // from [image1Height+1..image1Hight+image2Height] we draw the second image.
 
 - (void) drawFrameInRect: (NSRect) rect
+                   scale: (CGFloat) scale
 {
     NSImage* image = nil;
     NSSize srcSize;
@@ -179,65 +206,30 @@ static const CGFloat kAnimationIntervalSeconds = 0.03;  // 30ms, same as windows
     }
 }
 
-- (void) advanceFrame
+- (BOOL) advanceToTime: (NSTimeInterval) time
+         frameInterval: (NSTimeInterval) frameInterval
 {
-    ++_animationFrame;
-}
-
-@end
-
-// ThrobberTimer manages the animation of a set of ThrobberViews.  It allows
-// a single timer instance to be shared among as many ThrobberViews as needed.
+    if( _startTime < 0 )
+        _startTime = time;
 
-@interface AVTThrobberTimer : NSObject
+    NSInteger frame = (NSInteger)floor( (time - _startTime) / frameInterval );
+    frame = MIN( frame, (NSInteger)(_image1Size.height + _image2Size.height) );
+    if( frame == _animationFrame )
+        return NO;
 
-// Returns a shared AVTThrobberTimer.  Everyone is expected to use the same
-// instance.
-
-+ (AVTThrobberTimer*) sharedThrobberTimer;
-
-// Invalidates the timer, which will cause it to remove itself from the run
-// loop.  This causes the timer to be released, and it should then release
-// this object.
-
-- (void) invalidate;
-
-// Adds or removes ThrobberView objects from the _throbbers set.
-
-- (void) addThrobber: (AVTThrobberView*) throbber;
-- (void) removeThrobber: (AVTThrobberView*) throbber;
-
-// A set of weak references to each AVTThrobberView that should be notified whenever the timer fires.
-
-@property (nonatomic, retain) NSMutableSet* throbbers;
-
-// Weak reference to the timer that calls back to this object.  The timer retains this object.
-
-@property (nonatomic, assign) NSTimer* timer;
-
-// Whether the timer is actively running.  To avoid timer construction and destruction overhead, the timer is not invalidated
-// when it is not needed, but its next-fire date is set to [NSDate distantFuture]. It is not possible to determine whether the
-// timer has been suspended by comparing its fireDate to [NSDate distantFuture], though, so a separate variable is used to track
-// this state.
-
-@property (nonatomic, assign) BOOL timerRunning;
-
-// The thread that created this object.  Used to validate that AVTThrobberViews are only added and removed on the same thread
-// that the fire action will be performed on.
-
-@property (nonatomic, retain) NSThread* validThread;
+    _animationFrame = frame;
+    return YES;
+}
 
 @end
 
 @interface AVTThrobberTimer()
 
-// Starts or stops the timer as needed as AVTThrobberViews are added and removed from the _throbbers set.
-
-- (void) maintainTimer;
-
-// Calls animate on each AVTThrobberView in the _throbbers set.
+- (void) windowCameIntoView: (NSNotification*) notification;
 
-- (void) fire: (NSTimer*) timer;
+@property (nonatomic, retain) AVTFrameClock* clock;
+@property (nonatomic, retain) NSHashTable* throbbers;  // Not retained, see |-addThrobber:|.
+@property (nonatomic, assign) NSTimeInterval lastTickDuration;
 
 @end
 
@@ -247,90 +239,121 @@ static const CGFloat kAnimationIntervalSeconds = 0.03;  // 30ms, same as windows
 {
     static AVTThrobberTimer* sSharedInstance = nil;
     static dispatch_once_t predicate;
+    dispatch_once( &predicate, ^{
+        sSharedInstance = [[AVTThrobberTimer alloc] initWithFrameClock: [AVTFrameClock sharedClock]];
+    } );
 
-    if( sSharedInstance == nil )
-    {
-        dispatch_once( &predicate, ^
-        {
-            sSharedInstance = [AVTThrobberTimer alloc];
-            sSharedInstance = [sSharedInstance init];
-        } );
-    }
-    
     return sSharedInstance;
 }
 
-- (id) init
+- (id) initWithFrameClock: (AVTFrameClock*) clock
 {
     self = [super init];
     if( self != nil )
     {
-        // Start out with a timer that fires at the appropriate interval, but prevent it from firing by setting its
-        // next-fire date to the distant future.  Once a AVTThrobberView is added, the timer will be allowed to start firing.
-
-        _timer = [NSTimer scheduledTimerWithTimeInterval: kAnimationIntervalSeconds
-                                                  target: self
-                                                selector: @selector( fire: )
-                                                userInfo: nil
-                                                 repeats: YES];
-        [_timer setFireDate: [NSDate distantFuture]];
-        _timerRunning = NO;
-
-        _validThread = [NSThread currentThread];
+        _clock = [clock retain];
+        _frameInterval = kAnimationIntervalSeconds;
+        _throbbers = [[NSHashTable alloc] initWithOptions: NSPointerFunctionsOpaqueMemory | NSPointerFunctionsObjectPointerPersonality capacity: 0];
+
+        // Any of these can bring a sleeping throbber back into view. The occlusion notification only exists from 10.9.
+
+        NSArray* names = @[NSWindowDidDeminiaturizeNotification,
+                           NSWindowDidBecomeKeyNotification,
+                           NSWindowDidBecomeMainNotification,
+                           NSApplicationDidUnhideNotification];
+        if( &NSWindowDidChangeOcclusionStateNotification != NULL )
+            names = [names arrayByAddingObject: NSWindowDidChangeOcclusionStateNotification];
+
+        for( NSString* name in names )
+        {
+            [[NSNotificationCenter defaultCenter] addObserver: self
+                                                     selector: @selector( windowCameIntoView: )
+                                                         name: name
+                                                       object: nil];
+        }
     }
 
     return self;
 }
 
+- (void) dealloc
+{
+    [self invalidate];
+
+    [_clock release];
+    [_throbbers release];
+
+    [super dealloc];
+}
+
 - (void) invalidate
 {
-    [_timer invalidate];
+    [[NSNotificationCenter defaultCenter] removeObserver: self];
+    [self.clock deactivateClient: self];
 }
 
 - (void) addThrobber: (AVTThrobberView*) throbber
 {
-    assert( [NSThread currentThread] == _validThread );
+    NSAssert( [NSThread isMainThread], @"Throbbers are main thread only." );
 
-    [_throbbers addObject: throbber];
-    [self maintainTimer];
+    [self.throbbers addObject: throbber];
+    [self wake];
 }
 
 - (void) removeThrobber: (AVTThrobberView*) throbber
 {
-    assert( [NSThread currentThread] == _validThread );
+    NSAssert( [NSThread isMainThread], @"Throbbers are main thread only." );
 
-    [_throbbers removeObject: throbber];
-    [self maintainTimer];
+    [self.throbbers removeObject: throbber];
+    if( self.throbbers.count == 0 )
+        [self.clock deactivateClient: self];
 }
 
-- (void) maintainTimer
+- (void) wake
 {
-    BOOL oldRunning = _timerRunning;
-    BOOL newRunning = _throbbers.count ? NO : YES;
+    if( self.throbbers.count )
+        [self.clock activateClient: self];
+}
 
-    if( oldRunning == newRunning )
-        return;
+- (NSUInteger) throbberCount
+{
+    return self.throbbers.count;
+}
 
-    // To start the timer, set its next-fire date to an appropriate interval from
-    // now.  To suspend the timer, set its next-fire date to a preposterous time
-    // in the future.
+- (BOOL) isRunning
+{
+    return [self.clock isClientActive: self];
+}
 
-    NSDate* fireDate;
-    if( newRunning )
-        fireDate = [NSDate dateWithTimeIntervalSinceNow: kAnimationIntervalSeconds];
-    else
-        fireDate = [NSDate distantFuture];
+#pragma mark - AVTFrameClockClient
 
-    [_timer setFireDate: fireDate];
-    _timerRunning = newRunning;
-}
+// Throbbers may remove themselves as they animate (a finished toast does), so walk a snapshot. Returning NO once nothing on
+// screen is animating takes the timer off the clock until |-wake|.
 
-- (void) fire: (NSTimer*) timer
+- (BOOL) frameClock: (AVTFrameClock*) clock tickAtTime: (NSTimeInterval) time
 {
-    for( AVTThrobberView* throbber in self.throbbers )
+    CFTimeInterval tickStart = CACurrentMediaTime();
+
+    BOOL animating = NO;
+    for( AVTThrobberView* throbber in [self.throbbers allObjects] )
     {
-        [throbber animate];
+        if( ![self.throbbers containsObject: throbber] || ![throbber isOnScreen] )
+            continue;
+
+        [throbber animateToTime: time];
+        animating = YES;
     }
+
+    self.lastTickDuration = CACurrentMediaTime() - tickStart;
+
+    return animating && self.throbbers.count;
+}
+
+#pragma mark - Private
+
+- (void) windowCameIntoView: (NSNotification*) notification
+{
+    [self wake];
 }
 
 @end
@@ -361,6 +384,11 @@ static const CGFloat kAnimationIntervalSeconds = 0.03;  // 30ms, same as windows
                                           delegate: delegate] autorelease];
 }
 
+- (id) initWithFrame: (NSRect) frame
+{
+    return [self initWithFrame: frame delegate: nil];
+}
+
 - (id) initWithFrame: (NSRect) frame
             delegate: (id<AVTThrobberDataDelegate>) delegate
 {
@@ -368,6 +396,7 @@ static const CGFloat kAnimationIntervalSeconds = 0.03;  // 30ms, same as windows
     if( self != nil )
     {
         _dataDelegate = [delegate retain];
+        _throbberTimer = [[AVTThrobberTimer sharedThrobberTimer] retain];
     }
 
     return self;
@@ -375,23 +404,71 @@ static const CGFloat kAnimationIntervalSeconds = 0.03;  // 30ms, same as windows
 
 - (void) dealloc
 {
+    [_throbberTimer removeThrobber: self];
+    [_throbberTimer release];
     [_dataDelegate release];
-    [[AVTThrobberTimer sharedThrobberTimer] removeThrobber: self];
 
     [super dealloc];
 }
 
-// Manages this AVTThrobberView's membership in the shared throbber timer set on the basis of its visibility and
-// whether its animation needs to continue running.
+- (void) setFilmstripImage: (NSImage*) image
+{
+    self.dataDelegate = [[[AVTThrobberFilmstripDelegate alloc] initWithImage: image] autorelease];
+}
 
-- (void) maintainTimer
+- (void) setToastBeforeImage: (NSImage*) beforeImage
+                  afterImage: (NSImage*) afterImage
+{
+    self.dataDelegate = [[[AVTThrobberToastDelegate alloc] initWithImage1: beforeImage image2: afterImage] autorelease];
+}
+
+// A new delegate starts from its first frame, and a toast may need the timer again after a previous one completed.
+
+- (void) setDataDelegate: (id<AVTThrobberDataDelegate>) dataDelegate
+{
+    if( _dataDelegate != dataDelegate )
+    {
+        [_dataDelegate release];
+        _dataDelegate = [dataDelegate retain];
+
+        [self maintainTimer];
+        [self setNeedsDisplay: YES];
+    }
+}
+
+- (void) setThrobberTimer: (AVTThrobberTimer*) throbberTimer
 {
-    AVTThrobberTimer* throbberTimer = [AVTThrobberTimer sharedThrobberTimer];
+    if( _throbberTimer != throbberTimer )
+    {
+        [_throbberTimer removeThrobber: self];
+        [_throbberTimer release];
+        _throbberTimer = [throbberTimer retain];
+
+        [self maintainTimer];
+    }
+}
+
+- (BOOL) isOnScreen
+{
+    NSWindow* window = [self window];
+    if( window == nil || ![window isVisible] || [window isMiniaturized] || [NSApp isHidden] || [self isHiddenOrHasHiddenAncestor] )
+        return NO;
+
+    if( [window respondsToSelector: @selector( occlusionState )] )
+        return ([window occlusionState] & NSWindowOcclusionStateVisible) != 0;
+
+    return YES;
+}
 
-    if ([self window] && ![self isHidden] && ![_dataDelegate animationIsComplete])
-        [throbberTimer addThrobber: self];
+// Manages this AVTThrobberView's membership in the throbber timer on the basis of its visibility and whether its animation
+// needs to continue running. Windows coming and going from view are left to the timer, which checks every throbber it ticks.
+
+- (void) maintainTimer
+{
+    if( [self window] && ![self isHiddenOrHasHiddenAncestor] && ![_dataDelegate animationIsComplete] )
+        [self.throbberTimer addThrobber: self];
     else
-        [throbberTimer removeThrobber: self];
+        [self.throbberTimer removeThrobber: self];
 }
 
 // A AVTThrobberView added to a window may need to begin animating; a AVTThrobberView removed from a window should stop.
@@ -418,24 +495,110 @@ static const CGFloat kAnimationIntervalSeconds = 0.03;  // 30ms, same as windows
     [super viewDidUnhide];
 }
 
-// Called when the timer fires. Advance the frame, dirty the display, and remove the throbber if it's no longer needed.
+// Redraw if the frame changed, and leave the timer once the animation is complete.
 
-- (void) animate
+- (void) animateToTime: (NSTimeInterval) time
 {
-    [_dataDelegate advanceFrame];
-    [self setNeedsDisplay: YES];
+    if( [_dataDelegate advanceToTime: time frameInterval: self.throbberTimer.frameInterval] )
+        [self setNeedsDisplay: YES];
 
     if( [_dataDelegate animationIsComplete] )
-    {
-        [[AVTThrobberTimer sharedThrobberTimer] removeThrobber: self];
-    }
+        [self.throbberTimer removeThrobber: self];
 }
 
 // Overridden to draw the appropriate frame in the image strip.
 
 - (void) drawRect: (NSRect) rect
 {
-    [_dataDelegate drawFrameInRect: [self bounds]];
+    CGFloat scale = [self window] ? [[self window] backingScaleFactor] : 1.0f;
+    [_dataDelegate drawFrameInRect: [self bounds] scale: scale];
+}
+
+@end
+
+@implementation AVTFilmstripAtlas
+
++ (AVTFilmstripAtlas*) atlasForImage: (NSImage*) image
+                               scale: (CGFloat) scale
+{
+    static NSMapTable* sAtlases = nil;  // Image -> NSMutableDictionary of scale -> AVTFilmstripAtlas.
+    static dispatch_once_t onceToken;
+    dispatch_once( &onceToken, ^{
+        sAtlases = [[NSMapTable alloc] initWithKeyOptions: NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality
+                                             valueOptions: NSPointerFunctionsStrongMemory
+                                                 capacity: 0];
+    } );
+
+    NSMutableDictionary* scales = [sAtlases objectForKey: image];
+    if( scales == nil )
+    {
+        scales = [NSMutableDictionary dictionary];
+        [sAtlases setObject: scales forKey: image];
+    }
+
+    AVTFilmstripAtlas* atlas = scales[@(scale)];
+    if( atlas == nil )
+    {
+        atlas = [[[AVTFilmstripAtlas alloc] initWithImage: image scale: scale] autorelease];
+        scales[@(scale)] = atlas;
+    }
+
+    return atlas;
+}
+
+- (id) initWithImage: (NSImage*) image
+               scale: (CGFloat) scale
+{
+    self = [super init];
+    if( self != nil )
+    {
+        CGFloat side = [image size].height;
+        size_t pixels = (size_t)ceil( side * scale );
+
+        _frameCount = side > 0 ? (NSUInteger)([image size].width / side) : 0;
+        _frames = calloc( MAX( _frameCount, (NSUInteger)1 ), sizeof( CGImageRef ) );
+
+        CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+        for( NSUInteger i = 0; i < _frameCount; ++i )
+        {
+            CGContextRef context = CGBitmapContextCreate( NULL, pixels, pixels, 8, 0, colorSpace, kCGImageAlphaPremultipliedFirst | kCGBitmapByteOrder32Host );
+            if( context == NULL )
+                continue;
+
+            [NSGraphicsContext saveGraphicsState];
+            [NSGraphicsContext setCurrentContext: [NSGraphicsContext graphicsContextWithGraphicsPort: context flipped: NO]];
+            [image drawInRect: NSMakeRect( 0, 0, pixels, pixels )
+                     fromRect: NSMakeRect( i * side, 0, side, side )
+                    operation: NSCompositeCopy
+                     fraction: 1.0];
+            [NSGraphicsContext restoreGraphicsState];
+
+            _frames[i] = CGBitmapContextCreateImage( context );
+            CGContextRelease( context );
+        }
+        CGColorSpaceRelease( colorSpace );
+    }
+
+    return self;
+}
+
+- (void) dealloc
+{
+    for( NSUInteger i = 0; i < _frameCount; ++i )
+        CGImageRelease( _frames[i] );
+    free( _frames );
+
+    [super dealloc];
+}
+
+- (void) drawFrame: (NSUInteger) frame
+            inRect: (NSRect) rect
+{
+    if( frame >= _frameCount || _frames[frame] == NULL )
+        return;
+
+    CGContextRef context = [[NSGraphicsContext currentContext] graphicsPort];
+    CGContextDrawImage( context, NSRectToCGRect( rect ), _frames[frame] );
 }
 
 @end
@@ -12,4 +12,8 @@
 
 - (void) avt_setDuration: (NSTimeInterval) duration eventMask: (NSUInteger) eventMask;
 
+// Returns |duration| adjusted the same way as |-avt_setDuration:eventMask:|, for animations not run by an NSAnimationContext.
+
++ (NSTimeInterval) avt_duration: (NSTimeInterval) duration eventMask: (NSUInteger) eventMask;
+
 @end
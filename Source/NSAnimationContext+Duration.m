@@ -17,6 +17,11 @@ static NSTimeInterval AVTModifyDurationBasedOnCurrentState( NSTimeInterval durat
     [self setDuration: AVTModifyDurationBasedOnCurrentState( duration, eventMask )];
 }
 
++ (NSTimeInterval) avt_duration: (NSTimeInterval) duration eventMask: (NSUInteger) eventMask
+{
+    return AVTModifyDurationBasedOnCurrentState( duration, eventMask );
+}
+
 @end
 
 NSTimeInterval AVTModifyDurationBasedOnCurrentState( NSTimeInterval duration,
@@ -8,6 +8,8 @@
 #import "TestTabAppDelegate.h"
 
 #import "AVTContainerWindowController.h"
+#import "TestTabBenchmarks.h"
+#import "TestTabChecks.h"
 #import "TestTabContainer.h"
 
 @implementation TestTabAppDelegate
@@ -21,6 +23,20 @@
 
 - (void) applicationDidFinishLaunching: (NSNotification*) notification
 {
+    // Launched with "-RunChecks YES" the tester only runs the headless checks, and reports their result in its exit status.
+
+    if( [[NSUserDefaults standardUserDefaults] boolForKey: @"RunChecks"] )
+        exit( [TestTabChecks runAll] ? EXIT_SUCCESS : EXIT_FAILURE );
+
+    // Launched with "-RunBenchmarks YES" it runs the benchmarks, logs their results and quits.
+
+    if( [[NSUserDefaults standardUserDefaults] boolForKey: @"RunBenchmarks"] )
+    {
+        [TestTabBenchmarks runAll];
+        [NSApp terminate: self];
+        return;
+    }
+
     // Create a new container & window when we start
 
     self.windowController = [[[AVTContainerWindowController alloc] initWithContainer: [TestTabContainer container]] autorelease];
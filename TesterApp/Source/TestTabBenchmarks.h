@@ -0,0 +1,63 @@
+//
+//  TabbedWindowTester - TestTabBenchmarks.h
+//
+//  Copyright (c) 2013 Avatron Software, Inc. All rights reserved.
+//
+
+#import <Cocoa/Cocoa.h>
+
+// Benchmarks of the framework's drawing and bookkeeping, kept out of the framework itself. Launch the tester with
+// "-RunBenchmarks YES" to run them all, log the results and quit. Windows the benchmarks need are built offscreen and never shown.
+
+@interface TestTabBenchmarks : NSObject
+
+// Runs every benchmark and logs its results.
+
++ (void) runAll;
+
+// Draws |frameCount| frames of the filmstrip |image| through a throbber view, at the backing scale of the main screen, and returns
+// the average time of one frame. |stripDuration| receives the average time of one frame drawn as throbbers used to draw them, as
+// a clipped section of the whole image, if it isn't NULL. The throbber's frame atlas is cut before timing starts.
+
++ (NSTimeInterval) throbberFrameDurationWithImage: (NSImage*) image
+                                       frameCount: (NSUInteger) frameCount
+                                    stripDuration: (NSTimeInterval*) stripDuration;
+
+// Lays out a window of |tabCount| tabs and redraws its whole tab strip, tabs and their subviews included, |iterations| times, and
+// returns the average time of one redraw. |drawsTabsInStrip| selects the single pass or the per-view path for the duration.
+
++ (NSTimeInterval) stripRedrawDurationWithTabCount: (NSUInteger) tabCount
+                                        iterations: (NSUInteger) iterations
+                                  drawsTabsInStrip: (BOOL) drawsTabsInStrip;
+
+// Lays out a window of |tabCount| tabs |iterations| times, with most of the tabs moving every time, and returns the average time
+// of one layout.
+
++ (NSTimeInterval) layoutDurationWithTabCount: (NSUInteger) tabCount iterations: (NSUInteger) iterations;
+
+// Draws every tab of a window of |tabCount| tabs |iterations| times, background, glows and border as the tab itself or the tab well
+// draws them, and returns the average time of drawing one tab. |drawsFromCache| selects the shared tab bitmaps or drawing from
+// scratch for the duration.
+
++ (NSTimeInterval) tabDrawDurationWithTabCount: (NSUInteger) tabCount
+                                    iterations: (NSUInteger) iterations
+                                drawsFromCache: (BOOL) drawsFromCache;
+
+// Opens |documentCount| documents as new tabs in a window of one tab, the first of them selected, and returns the number opened per
+// second. The time counted runs until the tabs are laid out and the strip has been drawn. |batched| opens them with one call to
+// |-[AVTContainer addTabDocuments:atIndex:selecting:]| rather than one call to |-addTabDocument:atIndex:inForeground:| each.
+// |visitDuration| receives the time then taken to select every new tab once, which creates the document controllers the batch
+// left for later, if it isn't NULL.
+
++ (double) documentsOpenedPerSecondWithCount: (NSUInteger) documentCount
+                                     batched: (BOOL) batched
+                               visitDuration: (NSTimeInterval*) visitDuration;
+
+// Builds a search index of |entryCount| synthetic titles and runs |queryCount| queries on it, without any windows. Returns the
+// average time of one query; |buildDuration| receives the time taken to build the index if it isn't NULL.
+
++ (NSTimeInterval) searchQueryDurationWithEntryCount: (NSUInteger) entryCount
+                                          queryCount: (NSUInteger) queryCount
+                                       buildDuration: (NSTimeInterval*) buildDuration;
+
+@end
@@ -0,0 +1,448 @@
+//
+//  TabbedWindowTester - TestTabBenchmarks.m
+//
+//  Copyright (c) 2013 Avatron Software, Inc. All rights reserved.
+//
+
+#import "TestTabBenchmarks.h"
+
+#import <QuartzCore/QuartzCore.h>
+
+#import "AVTContainerWindowController.h"
+#import "AVTFrameClock.h"
+#import "AVTTabDocument.h"
+#import "AVTTabSearchIndex.h"
+#import "AVTTabView.h"
+#import "AVTTabWellController.h"
+#import "AVTTabWellView.h"
+#import "AVTThrobberView.h"
+#import "TestTabContainer.h"
+
+// Wide enough that a strip of kStripTabCount tabs lays them out at their full width.
+
+static const CGFloat kBenchmarkWindowWidth = 2400;
+static const NSUInteger kStripTabCount = 10;
+static const NSUInteger kLayoutTabCount = 1000;
+static const NSUInteger kOpenDocumentCount = 300;
+
+static const NSUInteger kSearchEntryCount = 50000;
+
+// Creates a bitmap context of |size| points at |scale| and makes it the current graphics context. Balance with
+// |TestEndOffscreenDrawing|.
+
+static CGContextRef TestBeginOffscreenDrawing( NSSize size, CGFloat scale );
+static void TestEndOffscreenDrawing( CGContextRef context );
+
+@interface TestTabBenchmarks()
+
++ (AVTContainerWindowController*) windowControllerWithTabCount: (NSUInteger) tabCount width: (CGFloat) width;
+
+@end
+
+@implementation TestTabBenchmarks
+
++ (void) runAll
+{
+    NSBundle* frameworkBundle = [NSBundle bundleForClass: [AVTThrobberView class]];
+    NSImage* throbber = [[[NSImage alloc] initWithContentsOfFile: [frameworkBundle pathForImageResource: @"throbber"]] autorelease];
+
+    NSTimeInterval stripDuration = 0;
+    NSTimeInterval atlasDuration = [self throbberFrameDurationWithImage: throbber frameCount: 10000 stripDuration: &stripDuration];
+    NSLog( @"Throbber frame: %.2f us from the atlas, %.2f us from the image strip", atlasDuration * 1e6, stripDuration * 1e6 );
+
+    NSTimeInterval singlePassDuration = [self stripRedrawDurationWithTabCount: kStripTabCount iterations: 500 drawsTabsInStrip: YES];
+    NSTimeInterval perViewDuration = [self stripRedrawDurationWithTabCount: kStripTabCount iterations: 500 drawsTabsInStrip: NO];
+    NSLog( @"Tab strip of %lu tabs: %.2f us to redraw in one pass, %.2f us tab view by tab view",
+           (unsigned long)kStripTabCount, singlePassDuration * 1e6, perViewDuration * 1e6 );
+
+    NSTimeInterval cachedDuration = [self tabDrawDurationWithTabCount: kStripTabCount iterations: 1000 drawsFromCache: YES];
+    NSTimeInterval uncachedDuration = [self tabDrawDurationWithTabCount: kStripTabCount iterations: 1000 drawsFromCache: NO];
+    NSLog( @"Tab draw: %.2f us from the tab bitmaps, %.2f us from scratch", cachedDuration * 1e6, uncachedDuration * 1e6 );
+
+    NSTimeInterval layoutDuration = [self layoutDurationWithTabCount: kLayoutTabCount iterations: 100];
+    NSLog( @"Tab layout of %lu tabs: %.2f ms", (unsigned long)kLayoutTabCount, layoutDuration * 1e3 );
+
+    NSTimeInterval batchVisitDuration = 0;
+    NSTimeInterval singleVisitDuration = 0;
+    double batchRate = [self documentsOpenedPerSecondWithCount: kOpenDocumentCount batched: YES visitDuration: &batchVisitDuration];
+    double singleRate = [self documentsOpenedPerSecondWithCount: kOpenDocumentCount batched: NO visitDuration: &singleVisitDuration];
+    NSLog( @"Opening %lu documents: %.0f per second in a batch then %.1f ms to visit each, %.0f per second one by one then %.1f ms",
+           (unsigned long)kOpenDocumentCount, batchRate, batchVisitDuration * 1e3, singleRate, singleVisitDuration * 1e3 );
+
+    NSTimeInterval buildDuration = 0;
+    NSTimeInterval queryDuration = [self searchQueryDurationWithEntryCount: kSearchEntryCount queryCount: 1000 buildDuration: &buildDuration];
+    NSLog( @"Tab search of %lu titles: %.1f ms to build, %.2f ms per query",
+           (unsigned long)kSearchEntryCount, buildDuration * 1e3, queryDuration * 1e3 );
+}
+
++ (NSTimeInterval) throbberFrameDurationWithImage: (NSImage*) image
+                                       frameCount: (NSUInteger) frameCount
+                                    stripDuration: (NSTimeInterval*) stripDuration
+{
+    if( stripDuration )
+        *stripDuration = 0;
+
+    CGFloat side = [image size].height;
+    NSUInteger numFrames = side > 0 ? (NSUInteger)([image size].width / side) : 0;
+    if( frameCount == 0 || numFrames == 0 )
+        return 0;
+
+    NSTimeInterval atlasDuration = 0;
+
+    @autoreleasepool
+    {
+        NSRect rect = NSMakeRect( 0, 0, side, side );
+
+        // The throbber takes its backing scale from its window, and is driven by hand rather than by the shared clock.
+
+        NSWindow* window = [[[NSWindow alloc] initWithContentRect: rect styleMask: NSBorderlessWindowMask backing: NSBackingStoreBuffered defer: NO] autorelease];
+        [window setReleasedWhenClosed: NO];
+        CGFloat scale = [window backingScaleFactor];
+
+        AVTFrameClock* clock = [[[AVTFrameClock alloc] initWithInterval: 1.0 / 60 timeSource: ^{ return 0.0; }] autorelease];
+        clock.automatic = NO;
+        AVTThrobberTimer* timer = [[[AVTThrobberTimer alloc] initWithFrameClock: clock] autorelease];
+
+        AVTThrobberView* throbber = [AVTThrobberView filmstripThrobberViewWithFrame: rect image: image];
+        throbber.throbberTimer = timer;
+        [[window contentView] addSubview: throbber];
+
+        CGContextRef context = TestBeginOffscreenDrawing( rect.size, scale );
+
+        // The first frame cuts the atlas. Each frame replaces the last, as it does on screen.
+
+        [throbber drawRect: rect];
+
+        CFTimeInterval start = CACurrentMediaTime();
+        for( NSUInteger i = 0; i < frameCount; i++ )
+        {
+            [throbber animateToTime: i * timer.frameInterval];
+            CGContextClearRect( context, NSRectToCGRect( rect ) );
+            [throbber drawRect: rect];
+        }
+        atlasDuration = (CACurrentMediaTime() - start) / frameCount;
+
+        start = CACurrentMediaTime();
+        for( NSUInteger i = 0; i < frameCount; i++ )
+        {
+            CGContextClearRect( context, NSRectToCGRect( rect ) );
+            [image drawInRect: rect
+                     fromRect: NSMakeRect( (i % numFrames) * side, 0, side, side )
+                    operation: NSCompositeSourceOver
+                     fraction: 1.0];
+        }
+        if( stripDuration )
+            *stripDuration = (CACurrentMediaTime() - start) / frameCount;
+
+        TestEndOffscreenDrawing( context );
+
+        [throbber removeFromSuperview];
+        [timer invalidate];
+        [window close];
+    }
+
+    return atlasDuration;
+}
+
++ (NSTimeInterval) stripRedrawDurationWithTabCount: (NSUInteger) tabCount
+                                        iterations: (NSUInteger) iterations
+                                  drawsTabsInStrip: (BOOL) drawsTabsInStrip
+{
+    if( tabCount == 0 || iterations == 0 )
+        return 0;
+
+    NSTimeInterval duration = 0;
+    BOOL didDrawTabsInStrip = [AVTTabWellView drawsTabsInStrip];
+    [AVTTabWellView setDrawsTabsInStrip: drawsTabsInStrip];
+
+    @autoreleasepool
+    {
+        AVTContainerWindowController* windowController = [self windowControllerWithTabCount: tabCount width: kBenchmarkWindowWidth];
+        AVTTabWellView* tabWellView = windowController.tabWellController.tabWellView;
+        NSRect bounds = tabWellView.bounds;
+        NSBitmapImageRep* bitmap = [tabWellView bitmapImageRepForCachingDisplayInRect: bounds];
+
+        // The first redraw renders the shared tab bitmaps and measures the titles.
+
+        [tabWellView cacheDisplayInRect: bounds toBitmapImageRep: bitmap];
+
+        CFTimeInterval start = CACurrentMediaTime();
+        for( NSUInteger i = 0; i < iterations; i++ )
+            [tabWellView cacheDisplayInRect: bounds toBitmapImageRep: bitmap];
+        duration = (CACurrentMediaTime() - start) / iterations;
+    }
+
+    [AVTTabWellView setDrawsTabsInStrip: didDrawTabsInStrip];
+
+    return duration;
+}
+
++ (NSTimeInterval) layoutDurationWithTabCount: (NSUInteger) tabCount
+                                   iterations: (NSUInteger) iterations
+{
+    if( tabCount == 0 || iterations == 0 )
+        return 0;
+
+    NSTimeInterval duration = 0;
+
+    @autoreleasepool
+    {
+        AVTContainerWindowController* windowController = [self windowControllerWithTabCount: tabCount width: kBenchmarkWindowWidth];
+        AVTContainer* container = windowController.container;
+        AVTTabWellController* tabWellController = windowController.tabWellController;
+
+        for( NSUInteger i = 0; i < iterations; i++ )
+        {
+            // With more tabs than fit the strip they are all at their narrowest, and the selected tab is wider than the rest. Moving
+            // the selection between the first and last tab moves every tab in between. Only the layout itself is timed.
+
+            [container selectTabAtIndex: (i % 2) ? 0 : tabCount - 1];
+
+            CFTimeInterval start = CACurrentMediaTime();
+            [tabWellController layoutTabs];
+            duration += CACurrentMediaTime() - start;
+        }
+        duration /= iterations;
+    }
+
+    return duration;
+}
+
++ (NSTimeInterval) tabDrawDurationWithTabCount: (NSUInteger) tabCount
+                                    iterations: (NSUInteger) iterations
+                                drawsFromCache: (BOOL) drawsFromCache
+{
+    if( tabCount == 0 || iterations == 0 )
+        return 0;
+
+    NSTimeInterval duration = 0;
+    BOOL didDrawFromCache = [AVTTabView drawsFromCache];
+    [AVTTabView setDrawsFromCache: drawsFromCache];
+
+    @autoreleasepool
+    {
+        AVTContainerWindowController* windowController = [self windowControllerWithTabCount: tabCount width: kBenchmarkWindowWidth];
+        AVTTabWellView* tabWellView = windowController.tabWellController.tabWellView;
+
+        NSMutableArray* tabViews = [NSMutableArray arrayWithCapacity: tabCount];
+        NSSize size = NSZeroSize;
+        for( NSView* view in tabWellView.subviews )
+        {
+            if( [view isKindOfClass: [AVTTabView class]] && !view.isHidden )
+            {
+                [tabViews addObject: view];
+                size.width = MAX( size.width, NSWidth( view.bounds ) );
+                size.height = MAX( size.height, NSHeight( view.bounds ) );
+            }
+        }
+
+        CGContextRef context = TestBeginOffscreenDrawing( size, [windowController.window backingScaleFactor] );
+        CGRect clearRect = CGRectMake( 0, 0, size.width, size.height );
+
+        // The first draw after a layout doesn't use the bitmaps, and renders the ones the tabs need.
+
+        for( AVTTabView* tabView in tabViews )
+            [tabView drawTab];
+
+        CFTimeInterval start = CACurrentMediaTime();
+        for( NSUInteger i = 0; i < iterations; i++ )
+        {
+            for( AVTTabView* tabView in tabViews )
+            {
+                CGContextClearRect( context, clearRect );
+                [tabView drawTab];
+            }
+        }
+        duration = tabViews.count ? (CACurrentMediaTime() - start) / (iterations * tabViews.count) : 0;
+
+        TestEndOffscreenDrawing( context );
+    }
+
+    [AVTTabView setDrawsFromCache: didDrawFromCache];
+
+    return duration;
+}
+
++ (double) documentsOpenedPerSecondWithCount: (NSUInteger) documentCount
+                                     batched: (BOOL) batched
+                               visitDuration: (NSTimeInterval*) visitDuration
+{
+    if( visitDuration )
+        *visitDuration = 0;
+
+    if( documentCount == 0 )
+        return 0;
+
+    NSTimeInterval duration = 0;
+
+    @autoreleasepool
+    {
+        AVTContainerWindowController* windowController = [self windowControllerWithTabCount: 1 width: kBenchmarkWindowWidth];
+        AVTContainer* container = windowController.container;
+        AVTTabWellController* tabWellController = windowController.tabWellController;
+        AVTTabWellView* tabWellView = tabWellController.tabWellView;
+        NSRect bounds = tabWellView.bounds;
+        NSBitmapImageRep* bitmap = [tabWellView bitmapImageRepForCachingDisplayInRect: bounds];
+
+        // Making the documents is the application's business, so it isn't counted.
+
+        NSMutableArray* documents = [NSMutableArray arrayWithCapacity: documentCount];
+        for( NSUInteger i = 0; i < documentCount; i++ )
+        {
+            AVTTabDocument* document = [container newBlankTabBasedOn: nil];
+            document.title = [NSString stringWithFormat: @"Document %lu", (unsigned long)i + 1];
+            [documents addObject: document];
+            [document release];
+        }
+
+        CFTimeInterval start = CACurrentMediaTime();
+        if( batched )
+        {
+            [container addTabDocuments: documents atIndex: -1 selecting: YES];
+        }
+        else
+        {
+            for( AVTTabDocument* document in documents )
+                [container addTabDocument: document atIndex: -1 inForeground: document == documents[0]];
+        }
+        [tabWellController layoutTabsIfNeeded];
+        [tabWellView cacheDisplayInRect: bounds toBitmapImageRep: bitmap];
+        duration = CACurrentMediaTime() - start;
+
+        start = CACurrentMediaTime();
+        for( NSUInteger i = 1; i <= documentCount; i++ )
+            [container selectTabAtIndex: i];
+        [tabWellController layoutTabsIfNeeded];
+        if( visitDuration )
+            *visitDuration = CACurrentMediaTime() - start;
+    }
+
+    return duration > 0 ? documentCount / duration : 0;
+}
+
++ (NSTimeInterval) searchQueryDurationWithEntryCount: (NSUInteger) entryCount
+                                          queryCount: (NSUInteger) queryCount
+                                       buildDuration: (NSTimeInterval*) buildDuration
+{
+    static NSString* const kWords[] =
+    {
+        @"Inbox", @"Project", @"Report", @"Weekly", @"Budget", @"Design", @"Review", @"Meeting", @"Notes", @"Draft", @"Invoice",
+        @"Calendar", @"Search", @"Results", @"Documentation", @"Release", @"Build", @"Status", @"Dashboard", @"Settings", @"Profile",
+        @"Photos", @"Music", @"Video", @"News", @"Weather", @"Travel", @"Recipes", @"Shopping", @"Café", @"Résumé", @"Forum",
+    };
+    const NSUInteger kWordCount = sizeof( kWords ) / sizeof( kWords[0] );
+
+    NSTimeInterval queryDuration = 0;
+
+    @autoreleasepool
+    {
+        // A fixed linear congruential sequence, so runs are comparable.
+
+        __block uint32_t seed = 12345;
+        uint32_t (^next)( uint32_t ) = ^( uint32_t range ) {
+            seed = seed * 1664525 + 1013904223;
+            return (seed >> 8) % range;
+        };
+
+        NSMutableArray* objects = [NSMutableArray arrayWithCapacity: entryCount];
+        NSMutableArray* titles = [NSMutableArray arrayWithCapacity: entryCount];
+        for( NSUInteger i = 0; i < entryCount; i++ )
+        {
+            NSMutableString* title = [NSMutableString string];
+            uint32_t wordCount = 2 + next( 4 );
+            for( uint32_t w = 0; w < wordCount; w++ )
+                [title appendFormat: @"%@%@", w ? @" " : @"", kWords[next( kWordCount )]];
+            [title appendFormat: @" - %u", next( 10000 )];
+
+            [titles addObject: title];
+            [objects addObject: [[[NSObject alloc] init] autorelease]];
+        }
+
+        NSMutableArray* queries = [NSMutableArray arrayWithCapacity: queryCount];
+        for( NSUInteger i = 0; i < queryCount; i++ )
+        {
+            // Fragments of one or two words, as someone types them.
+
+            NSString* word = kWords[next( kWordCount )];
+            NSUInteger length = MIN( word.length, 2 + next( 5 ) );
+            NSString* query = [word substringWithRange: NSMakeRange( next( (uint32_t)(word.length - length + 1) ), length )];
+            if( next( 3 ) == 0 )
+                query = [query stringByAppendingFormat: @" %@", [kWords[next( kWordCount )] substringToIndex: 2]];
+
+            [queries addObject: query];
+        }
+
+        AVTTabSearchIndex* index = [[[AVTTabSearchIndex alloc] initWithByteLimit: NSUIntegerMax] autorelease];
+
+        CFTimeInterval start = CACurrentMediaTime();
+        for( NSUInteger i = 0; i < entryCount; i++ )
+            [index setTitle: titles[i] forObject: objects[i]];
+        if( buildDuration )
+            *buildDuration = CACurrentMediaTime() - start;
+
+        start = CACurrentMediaTime();
+        for( NSString* query in queries )
+            [index objectsMatchingQuery: query limit: 20];
+        queryDuration = queryCount ? (CACurrentMediaTime() - start) / queryCount : 0;
+
+        // The index doesn't retain its objects, which go before it when the pool drains.
+
+        [index removeAllObjects];
+    }
+
+    return queryDuration;
+}
+
+#pragma mark - Private
+
+// A container window of |tabCount| blank tester tabs, the first of them selected, |width| points wide and laid out. The window is
+// never shown, so nothing in it animates. It doesn't save its frame over the tester's own window's.
+
++ (AVTContainerWindowController*) windowControllerWithTabCount: (NSUInteger) tabCount
+                                                         width: (CGFloat) width
+{
+    AVTContainer* container = [TestTabContainer container];
+    AVTContainerWindowController* windowController = [[[AVTContainerWindowController alloc] initWithContainer: container] autorelease];
+    [windowController setWindowFrameAutosaveName: @""];
+
+    NSWindow* window = windowController.window;
+    NSRect frame = window.frame;
+    frame.size.width = width;
+    [window setFrame: frame display: NO];
+
+    NSMutableArray* documents = [NSMutableArray arrayWithCapacity: tabCount];
+    for( NSUInteger i = 0; i < tabCount; i++ )
+    {
+        AVTTabDocument* document = [container newBlankTabBasedOn: nil];
+        document.title = [NSString stringWithFormat: @"Benchmark %lu", (unsigned long)i + 1];
+        [documents addObject: document];
+        [document release];
+    }
+
+    [container addTabDocuments: documents atIndex: -1 selecting: YES];
+    [windowController.tabWellController layoutTabs];
+
+    return windowController;
+}
+
+@end
+
+CGContextRef TestBeginOffscreenDrawing( NSSize size, CGFloat scale )
+{
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    CGContextRef context = CGBitmapContextCreate( NULL, (size_t)ceil( size.width * scale ), (size_t)ceil( size.height * scale ), 8, 0, colorSpace, kCGImageAlphaPremultipliedFirst | kCGBitmapByteOrder32Host );
+    CGColorSpaceRelease( colorSpace );
+
+    CGContextScaleCTM( context, scale, scale );
+
+    [NSGraphicsContext saveGraphicsState];
+    [NSGraphicsContext setCurrentContext: [NSGraphicsContext graphicsContextWithGraphicsPort: context flipped: NO]];
+
+    return context;
+}
+
+void TestEndOffscreenDrawing( CGContextRef context )
+{
+    [NSGraphicsContext restoreGraphicsState];
+    CGContextRelease( context );
+}
@@ -0,0 +1,25 @@
+//
+//  TabbedWindowTester - TestTabChecks.h
+//
+//  Copyright (c) 2013 Avatron Software, Inc. All rights reserved.
+//
+
+#import <Cocoa/Cocoa.h>
+
+// Checks of framework logic that runs without windows. Launch the tester with "-RunChecks YES" to run them all and quit with a
+// failing status if any of them fail.
+
+@interface TestTabChecks : NSObject
+
+// Runs every check, logging each failure. Returns NO if any failed.
+
++ (BOOL) runAll;
+
+// |AVTTabGlowStep| on a simulated clock: the rise, hold and fall of the hover glow and of the alert glow, the alert's states, and
+// the delays returned along the way, |kGlowNoUpdate| once a glow has settled included.
+
++ (BOOL) checkHoverGlow;
++ (BOOL) checkAlertGlow;
++ (BOOL) checkCombinedGlows;
+
+@end
@@ -0,0 +1,183 @@
+//
+//  TabbedWindowTester - TestTabChecks.m
+//
+//  Copyright (c) 2013 Avatron Software, Inc. All rights reserved.
+//
+
+#import "TestTabChecks.h"
+
+#import "AVTTabGlow.h"
+
+// Logs |what| if |condition| is false, and returns |condition|.
+
+static BOOL TestExpect( BOOL condition, NSString* what, NSTimeInterval time );
+
+// The most steps a glow may take to rise or fall over |duration|: one more than it needs, in case the alpha misses its limit by a
+// rounding error.
+
+static NSUInteger TestGlowStepLimit( NSTimeInterval duration );
+
+@implementation TestTabChecks
+
++ (BOOL) runAll
+{
+    BOOL passed = YES;
+    passed &= [self checkHoverGlow];
+    passed &= [self checkAlertGlow];
+    passed &= [self checkCombinedGlows];
+
+    NSLog( @"Checks %@", passed ? @"passed" : @"FAILED" );
+    return passed;
+}
+
++ (BOOL) checkHoverGlow
+{
+    const NSTimeInterval dt = kGlowUpdateInterval;
+    NSTimeInterval time = 100;
+    NSTimeInterval delay = 0;
+    NSUInteger steps = 0;
+
+    AVTTabGlowState state;
+    memset( &state, 0, sizeof( state ) );
+
+    // A settled tab needs nothing.
+
+    if( !TestExpect( AVTTabGlowStep( &state, time, dt ) == kGlowNoUpdate, @"idle tab asks for an update", time ) )
+        return NO;
+
+    // Hover rises while the mouse is inside, a step at a time, then settles at 1.
+
+    state.mouseInside = YES;
+    for( steps = 0; state.hoverAlpha < 1; steps++ )
+    {
+        CGFloat previous = state.hoverAlpha;
+        time += dt;
+        delay = AVTTabGlowStep( &state, time, dt );
+        if( !TestExpect( state.hoverAlpha > previous && delay == kGlowUpdateInterval, @"hover glow doesn't rise", time ) ||
+            !TestExpect( steps < TestGlowStepLimit( kHoverShowDuration ), @"hover glow rises too slowly", time ) )
+            return NO;
+    }
+
+    time += dt;
+    if( !TestExpect( AVTTabGlowStep( &state, time, dt ) == kGlowNoUpdate && state.hoverAlpha == 1, @"full hover glow doesn't settle", time ) )
+        return NO;
+
+    // Once the mouse leaves, hover holds until the hold time and asks to be stepped again then.
+
+    state.mouseInside = NO;
+    state.hoverHoldEndTime = time + kHoverHoldDuration;
+    delay = AVTTabGlowStep( &state, time, dt );
+    if( !TestExpect( state.hoverAlpha == 1 && fabs( delay - kHoverHoldDuration ) < 1e-9, @"hover glow doesn't hold", time ) )
+        return NO;
+
+    // Then it falls to 0 and settles.
+
+    time = state.hoverHoldEndTime;
+    for( steps = 0; state.hoverAlpha > 0; steps++ )
+    {
+        CGFloat previous = state.hoverAlpha;
+        time += dt;
+        delay = AVTTabGlowStep( &state, time, dt );
+        if( !TestExpect( state.hoverAlpha < previous && delay == kGlowUpdateInterval, @"hover glow doesn't fall", time ) ||
+            !TestExpect( steps < TestGlowStepLimit( kHoverHideDuration ), @"hover glow falls too slowly", time ) )
+            return NO;
+    }
+
+    time += dt;
+    return TestExpect( AVTTabGlowStep( &state, time, dt ) == kGlowNoUpdate, @"faded hover glow doesn't settle", time );
+}
+
++ (BOOL) checkAlertGlow
+{
+    const NSTimeInterval dt = kGlowUpdateInterval;
+    NSTimeInterval time = 100;
+    NSTimeInterval delay = 0;
+    NSUInteger steps = 0;
+
+    AVTTabGlowState state;
+    memset( &state, 0, sizeof( state ) );
+
+    // An alert rises to 1, then switches to holding and asks to be stepped again at the end of the hold.
+
+    state.alertState = eAlertRising;
+    for( steps = 0; state.alertState == eAlertRising; steps++ )
+    {
+        CGFloat previous = state.alertAlpha;
+        time += dt;
+        delay = AVTTabGlowStep( &state, time, dt );
+        if( !TestExpect( state.alertAlpha > previous, @"alert glow doesn't rise", time ) ||
+            !TestExpect( steps < TestGlowStepLimit( kAlertShowDuration ), @"alert glow rises too slowly", time ) )
+            return NO;
+
+        if( state.alertState == eAlertRising && !TestExpect( delay == kGlowUpdateInterval, @"rising alert glow isn't stepped every interval", time ) )
+            return NO;
+    }
+
+    if( !TestExpect( state.alertState == eAlertHolding && state.alertAlpha == 1, @"full alert glow doesn't hold", time ) ||
+        !TestExpect( delay == kAlertHoldDuration && state.alertHoldEndTime == time + kAlertHoldDuration, @"alert hold is scheduled wrong", time ) )
+        return NO;
+
+    // Halfway through the hold nothing changes but the delay.
+
+    time += kAlertHoldDuration / 2;
+    delay = AVTTabGlowStep( &state, time, dt );
+    if( !TestExpect( state.alertState == eAlertHolding && state.alertAlpha == 1, @"alert glow changes while holding", time ) ||
+        !TestExpect( fabs( delay - (state.alertHoldEndTime - time) ) < 1e-9, @"holding alert glow isn't stepped at the end of the hold", time ) )
+        return NO;
+
+    // At the end of the hold the alert starts falling, falls to 0, then returns to none and settles.
+
+    time = state.alertHoldEndTime;
+    delay = AVTTabGlowStep( &state, time, dt );
+    if( !TestExpect( state.alertState == eAlertFalling && state.alertAlpha == 1 && delay == kGlowUpdateInterval, @"alert glow doesn't start falling", time ) )
+        return NO;
+
+    for( steps = 0; state.alertAlpha > 0; steps++ )
+    {
+        CGFloat previous = state.alertAlpha;
+        time += dt;
+        delay = AVTTabGlowStep( &state, time, dt );
+        if( !TestExpect( state.alertAlpha < previous && delay == kGlowUpdateInterval, @"alert glow doesn't fall", time ) ||
+            !TestExpect( steps < TestGlowStepLimit( kAlertHideDuration ), @"alert glow falls too slowly", time ) )
+            return NO;
+    }
+
+    time += dt;
+    delay = AVTTabGlowStep( &state, time, dt );
+    return TestExpect( state.alertState == eAlertNone && delay == kGlowNoUpdate, @"faded alert glow doesn't settle", time );
+}
+
++ (BOOL) checkCombinedGlows
+{
+    const NSTimeInterval dt = kGlowUpdateInterval;
+    NSTimeInterval time = 100;
+
+    AVTTabGlowState state;
+    memset( &state, 0, sizeof( state ) );
+
+    // A holding alert alone waits for the end of its hold; a rising hover glow alongside it wins with the sooner delay.
+
+    state.alertState = eAlertHolding;
+    state.alertAlpha = 1;
+    state.alertHoldEndTime = time + kAlertHoldDuration;
+    if( !TestExpect( fabs( AVTTabGlowStep( &state, time, dt ) - kAlertHoldDuration ) < 1e-9, @"holding alert glow isn't stepped at the end of the hold", time ) )
+        return NO;
+
+    state.mouseInside = YES;
+    return TestExpect( AVTTabGlowStep( &state, time, dt ) == kGlowUpdateInterval, @"rising hover glow doesn't shorten the alert's delay", time );
+}
+
+@end
+
+BOOL TestExpect( BOOL condition, NSString* what, NSTimeInterval time )
+{
+    if( !condition )
+        NSLog( @"Check failed: %@ at %.3f", what, time );
+
+    return condition;
+}
+
+NSUInteger TestGlowStepLimit( NSTimeInterval duration )
+{
+    return (NSUInteger)ceil( duration / kGlowUpdateInterval ) + 1;
+}